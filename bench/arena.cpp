@@ -0,0 +1,112 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/mem.hpp>
+#include <lib/vec.hpp>
+
+#include "bench.hpp"
+
+// Allocate a tree's worth of small nodes and release them all, as
+// a document's parse would, with `br::alloc`/`br::free` per node
+// against an arena released in one go.
+int main(int argc, const char* argv[]) {
+	constexpr br::size_t nodes = 1 << 20;
+
+	struct node {
+		node* next;
+		br::u64_t value[3];
+	};
+
+	node** const ptrs = br::alloc<node*>(nodes);
+
+	const auto heap = br::bench(5, [&] {
+		for (br::index_t i = 0; i != nodes; ++i) {
+			ptrs[i] = br::alloc<node>();
+			ptrs[i]->value[0] = i;
+			br::keep(ptrs[i]);
+		}
+
+		for (br::index_t i = 0; i != nodes; ++i)
+			br::free(ptrs[i]);
+	});
+
+	br::report("br::alloc + br::free (1M nodes)", heap);
+
+	auto a = br::make_arena();
+	const auto mark = br::mark_arena(a);
+
+	const auto reused = br::bench(5, [&] {
+		for (br::index_t i = 0; i != nodes; ++i) {
+			node* n;
+			a = br::arena_alloc(a, 1, n);
+			n->value[0] = i;
+			br::keep(n);
+		}
+
+		a = br::rewind_arena(a, mark);
+	});
+
+	br::report("br::arena_alloc + rewind (1M nodes)", reused);
+
+	const auto fresh = br::bench(5, [&] {
+		auto b = br::make_arena();
+
+		for (br::index_t i = 0; i != nodes; ++i) {
+			node* n;
+			b = br::arena_alloc(b, 1, n);
+			n->value[0] = i;
+			br::keep(n);
+		}
+
+		b = br::destroy_arena(b);
+	});
+
+	br::report("br::arena_alloc + destroy (1M nodes)", fresh);
+
+	// Short lived vectors, as an expansion would build for its
+	// arguments, destroyed one by one or released together with
+	// the expansion's arena.
+	constexpr br::size_t expansions = 1 << 13;
+	constexpr br::size_t arguments = 8;
+
+	const auto heap_vecs = br::bench(5, [&] {
+		for (br::index_t i = 0; i != expansions; ++i) {
+			br::vec<br::u64_t> args[arguments];
+
+			for (auto& v: args) {
+				v = br::make_vec<br::u64_t>();
+
+				for (br::index_t j = 0; j != 24; ++j)
+					v = br::push(v, j);
+
+				br::keep(v.data);
+			}
+
+			for (auto& v: args)
+				v = br::destroy_vec(v);
+		}
+	});
+
+	br::report("heap vec (8K expansions)", heap_vecs);
+
+	const auto arena_vecs = br::bench(5, [&] {
+		for (br::index_t i = 0; i != expansions; ++i) {
+			for (br::index_t k = 0; k != arguments; ++k) {
+				auto v = br::make_vec<br::u64_t>(br::arena_allocator { &a });
+
+				for (br::index_t j = 0; j != 24; ++j)
+					v = br::push(v, j);
+
+				br::keep(v.data);
+			}
+
+			a = br::rewind_arena(a, mark);
+		}
+	});
+
+	br::report("arena vec (8K expansions)", arena_vecs);
+
+	a = br::destroy_arena(a);
+	br::free(ptrs);
+
+	return br::EXIT_SUCCESS;
+}
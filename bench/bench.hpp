@@ -0,0 +1,55 @@
+#ifndef BR_BENCH_H
+#define BR_BENCH_H
+
+#include <cstdio>
+#include <ctime>
+
+#include <lib/def.hpp>
+
+// Tiny benchmarking helpers.
+// Build and run everything in bench/ with `make bench debug=no`.
+
+namespace br {
+
+	// Monotonic time in nanoseconds.
+	inline u64_t now_ns() {
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (u64_t)ts.tv_sec * 1'000'000'000ull + ts.tv_nsec;
+	}
+
+	// Stop the compiler from optimising away a result.
+	template <typename T>
+	inline void keep(const T& x) {
+		asm volatile("" : : "r,m"(x) : "memory");
+	}
+
+	// Run `fn` `reps` times and return the best time in nanoseconds.
+	template <typename F>
+	inline u64_t bench(size_t reps, F fn) {
+		u64_t best = limit_max<u64_t>();
+
+		for (index_t i = 0; i != reps; ++i) {
+			const u64_t start = now_ns();
+			fn();
+			const u64_t elapsed = now_ns() - start;
+
+			best = elapsed < best ? elapsed : best;
+		}
+
+		return best;
+	}
+
+	// Print a result as `name: time (throughput)`.
+	inline void report(const char* name, u64_t ns, size_t bytes = 0) {
+		if (bytes == 0) {
+			std::printf("%-40s %12.3f ms\n", name, ns / 1e6);
+			return;
+		}
+
+		std::printf("%-40s %12.3f ms %10.2f GiB/s\n", name, ns / 1e6, (bytes / (double)(1ull << 30)) / (ns / 1e9));
+	}
+
+}
+
+#endif
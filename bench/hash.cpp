@@ -0,0 +1,64 @@
+#include <functional>
+#include <string_view>
+
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/str.hpp>
+#include <lib/vec.hpp>
+#include <lib/hash.hpp>
+
+#include "bench.hpp"
+
+// br::hash against FNV-1a and std::hash over keys of several sizes.
+// Short keys are what symbol tables see, long keys are what
+// include deduplication sees.
+inline br::u64_t fnv1a(br::str_view sv) {
+	br::u64_t h = 0xcbf29ce484222325ull;
+
+	for (auto ptr = sv.begin; ptr != sv.end; ++ptr)
+		h = (h ^ (br::u8_t)*ptr) * 0x100000001b3ull;
+
+	return h;
+}
+
+int main(int argc, const char* argv[]) {
+	constexpr br::size_t total = 64ull << 20;
+
+	auto buf = br::make_vec<char>();
+
+	for (br::index_t i = 0; i != total; ++i)
+		buf = br::push(buf, (char)('a' + (i * 7) % 26));
+
+	const br::size_t sizes[] = { 8, 16, 32, 64, 256, 4096, total };
+
+	for (auto size: sizes) {
+		const br::size_t count = total / size;
+		char name[64];
+
+		const auto run = [&] (auto fn) {
+			return br::bench(5, [&] {
+				br::u64_t acc = 0;
+
+				for (br::index_t i = 0; i != count; ++i)
+					acc ^= fn(br::make_sv(buf.data + i * size, size));
+
+				br::keep(acc);
+			});
+		};
+
+		std::snprintf(name, sizeof(name), "br::hash (%lu bytes)", (unsigned long)size);
+		br::report(name, run([] (br::str_view sv) { return br::hash(sv); }), total);
+
+		std::snprintf(name, sizeof(name), "fnv1a (%lu bytes)", (unsigned long)size);
+		br::report(name, run(fnv1a), total);
+
+		std::snprintf(name, sizeof(name), "std::hash (%lu bytes)", (unsigned long)size);
+		br::report(name, run([] (br::str_view sv) {
+			return (br::u64_t)std::hash<std::string_view> {} ({ sv.begin, br::length(sv) });
+		}), total);
+	}
+
+	buf = br::destroy_vec(buf);
+
+	return br::EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstring>
+
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/str.hpp>
+#include <lib/vec.hpp>
+#include <lib/intern.hpp>
+
+#include "bench.hpp"
+
+// Intern a stream of identifiers drawn from a small vocabulary,
+// as macro names in a document would be, then compare lookups by
+// symbol against lookups by string.
+int main(int argc, const char* argv[]) {
+	constexpr br::size_t vocabulary = 4096;
+	constexpr br::size_t tokens = 1 << 20;
+
+	char names[vocabulary][16];
+	br::str_view stream[64];
+
+	for (br::index_t i = 0; i != vocabulary; ++i)
+		std::snprintf(names[i], sizeof(names[i]), "macro%lu", (unsigned long)i);
+
+	for (br::index_t i = 0; i != br::length(stream); ++i)
+		stream[i] = br::make_sv(names[(i * 2654435761u) % vocabulary], std::strlen(names[(i * 2654435761u) % vocabulary]));
+
+	auto in = br::make_interner();
+
+	const auto build = br::bench(5, [&] {
+		for (br::index_t i = 0; i != tokens; ++i) {
+			br::symbol_t id;
+			const auto name = names[(i * 2654435761u) % vocabulary];
+
+			in = br::intern(in, br::make_sv(name, std::strlen(name)), id);
+			br::keep(id);
+		}
+	});
+
+	br::report("intern (1M tokens, 4K unique)", build);
+
+	const auto target = br::find_symbol(in, stream[0]);
+	br::symbol_t syms[br::length(stream)];
+
+	for (br::index_t i = 0; i != br::length(stream); ++i)
+		syms[i] = br::find_symbol(in, stream[i]);
+
+	const auto by_string = br::bench(5, [&] {
+		br::size_t count = 0;
+
+		for (br::index_t i = 0; i != tokens; ++i)
+			count += br::eq(stream[i % br::length(stream)], stream[0]);
+
+		br::keep(count);
+	});
+
+	const auto by_symbol = br::bench(5, [&] {
+		br::size_t count = 0;
+
+		for (br::index_t i = 0; i != tokens; ++i)
+			count += syms[i % br::length(stream)] == target;
+
+		br::keep(count);
+	});
+
+	br::report("compare by string (1M)", by_string);
+	br::report("compare by symbol (1M)", by_symbol);
+
+	std::printf("%lu symbols, %lu KiB\n", (unsigned long)br::length(in), (unsigned long)(br::memory_footprint(in) / 1024));
+
+	in = br::destroy_interner(in);
+
+	return br::EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#include <cstring>
+
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/mem.hpp>
+
+#include "bench.hpp"
+
+// br::memcpy, br::memmove and br::fill against libc from a few bytes
+// up to buffers much larger than the last level cache. Every size
+// moves the same total number of bytes. Then growing a large buffer
+// through `realloc` against the mapped path.
+int main(int argc, const char* argv[]) {
+	constexpr br::size_t largest = 64ull << 20;
+	constexpr br::size_t total = 256ull << 20;
+
+	// Offset by a few bytes so neither side is vector aligned.
+	char* const a = br::alloc<char>(largest + 64);
+	char* const b = br::alloc<char>(largest + 64);
+
+	char* const src = a + 3;
+	char* dest = b + 5;
+
+	std::memset(a, 'a', largest + 64);
+	std::memset(b, 'b', largest + 64);
+
+	const br::size_t sizes[] = {
+		8, 16, 32, 64, 128, 256, 512, 1024, 4096, 16384, 65536,
+		256ull << 10, 1ull << 20, 4ull << 20, 16ull << 20, largest,
+	};
+
+	for (auto size: sizes) {
+		const br::size_t count = total / size;
+		char name[64];
+
+		const auto run = [&] (const char* fn, auto op) {
+			const auto ns = br::bench(5, [&] {
+				for (br::index_t i = 0; i != count; ++i) {
+					op(size);
+					br::keep(dest);
+				}
+			});
+
+			std::snprintf(name, sizeof(name), "%s (%lu bytes)", fn, (unsigned long)size);
+			br::report(name, ns, total);
+		};
+
+		run("br::memcpy", [&] (br::size_t n) { br::memcpy(src, dest, n); });
+		run("std::memcpy", [&] (br::size_t n) { std::memcpy(dest, src, n); });
+
+		// Overlapping by all but a few bytes.
+		run("br::memmove", [&] (br::size_t n) { br::memmove(dest, dest + 7, n); });
+		run("std::memmove", [&] (br::size_t n) { std::memmove(dest + 7, dest, n); });
+
+		run("br::fill", [&] (br::size_t n) { br::fill(dest, n, (char)n); });
+		run("std::memset", [&] (br::size_t n) { std::memset(dest, (char)n, n); });
+	}
+
+	br::free(a);
+	br::free(b);
+
+	// Grow a 512 MiB buffer by 1.5x at a time the way `vec` does,
+	// writing every element, through `realloc` and the mapped path.
+	constexpr br::size_t elements = (512ull << 20) / sizeof(br::u64_t);
+
+	const auto grow = [&] (const char* name, auto alloc, auto free) {
+		const auto ns = br::bench(3, [&] {
+			br::size_t cap = br::VEC_MINIMUM_LENGTH;
+			br::u64_t* ptr = alloc(cap, (br::u64_t*)nullptr);
+
+			for (br::index_t i = 0; i != elements; ++i) {
+				if (i == cap) {
+					cap += cap / 2;
+					ptr = alloc(cap, ptr);
+				}
+
+				ptr[i] = i;
+			}
+
+			br::keep(ptr);
+			free(ptr);
+		});
+
+		br::report(name, ns, elements * sizeof(br::u64_t));
+	};
+
+	grow("grow with br::alloc (512 MiB)",
+		[] (br::size_t n, br::u64_t* p) { return br::alloc<br::u64_t>(n, p); },
+		[] (br::u64_t* p) { br::free(p); });
+
+	grow("grow with br::map_alloc (512 MiB)",
+		[] (br::size_t n, br::u64_t* p) { return br::map_alloc<br::u64_t>(n, p); },
+		[] (br::u64_t* p) { br::map_free(p); });
+
+	return br::EXIT_SUCCESS;
+}
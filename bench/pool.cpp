@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <thread>
+
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/mem.hpp>
+#include <lib/pool.hpp>
+
+#include "bench.hpp"
+
+// Churn through short lived nodes the way expansion does, keeping a
+// window of live ones per thread, with `br::alloc`/`br::free` against
+// a pool with per-thread caches.
+int main(int argc, const char* argv[]) {
+	constexpr br::size_t ops = 1 << 22;
+	constexpr br::size_t window = 256;
+
+	struct node {
+		node* next;
+		br::u64_t value[5];
+	};
+
+	// Replace a pseudo-random slot of the window each step.
+	const auto window_churn = [&] (br::size_t steps, auto alloc, auto free) {
+		node* live[window] = {};
+
+		for (br::index_t i = 0; i != steps; ++i) {
+			node*& slot = live[(i * 97) % window];
+
+			free(slot);
+			slot = alloc();
+			slot->value[0] = i;
+		}
+
+		for (auto n: live)
+			free(n);
+	};
+
+	const auto run = [&] (br::size_t threads, auto work) {
+		return br::bench(5, [&] {
+			std::thread ts[8];
+
+			for (br::index_t i = 0; i != threads; ++i)
+				ts[i] = std::thread(work, ops / threads);
+
+			for (br::index_t i = 0; i != threads; ++i)
+				ts[i].join();
+		});
+	};
+
+	auto p = br::make_pool<node>();
+
+	const br::size_t counts[] = { 1, 4, 8 };
+
+	for (auto threads: counts) {
+		char name[64];
+
+		const auto heap = run(threads, [&] (br::size_t steps) {
+			window_churn(steps,
+				[] { return br::alloc<node>(); },
+				[] (node* n) { br::free(n); });
+		});
+
+		std::snprintf(name, sizeof(name), "br::alloc (%lu threads)", (unsigned long)threads);
+		br::report(name, heap);
+
+		const auto pooled = run(threads, [&] (br::size_t steps) {
+			br::pool_cache<node> c;
+
+			window_churn(steps,
+				[&] { return br::pool_alloc(p, c); },
+				[&] (node* n) { br::pool_free(p, c, n); });
+
+			br::drain_pool_cache(p, c);
+		});
+
+		std::snprintf(name, sizeof(name), "br::pool_alloc (%lu threads)", (unsigned long)threads);
+		br::report(name, pooled);
+	}
+
+	const auto s = br::stats(p);
+	std::printf("cache hit rate %.2f%%, %lu slabs\n", 100.0 * s.hits / s.allocs, (unsigned long)s.slabs);
+
+	p = br::destroy_pool(p);
+
+	return br::EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/str.hpp>
+#include <lib/vec.hpp>
+
+#include "bench.hpp"
+
+// Bulk `utf_decode`/`utf_encode` against a loop over the single
+// codepoint functions on ~4 MiB documents in different scripts.
+int main(int argc, const char* argv[]) {
+	struct {
+		const char* name;
+		br::str_view chunk;
+	} docs[] = {
+		{ "ascii",    cstr("The quick brown fox jumps over the lazy dog, 1234567890! ") },
+		{ "latin",    cstr("Voix ambiguë d'un cœur qui, au zéphyr, préfère les jattes de kiwis. ") },
+		{ "greek",    cstr("Γαζέες καὶ μυρτιὲς δὲν θὰ βρῶ πιὰ στὸ χρυσαφὶ ξέφωτο. ") },
+		{ "cyrillic", cstr("Съешь же ещё этих мягких французских булок, да выпей чаю. ") },
+		{ "cjk",      cstr("我能吞下玻璃而不伤身体。日本語の文章、カタカナとひらがな。") },
+		{ "emoji",    cstr("Party 😀🎉 at 8pm, bring 🍕 and 🍺 please 👍🏽 ") },
+	};
+
+	for (auto doc: docs) {
+		auto bytes = br::make_vec<char>();
+
+		while (br::length(bytes) < (4ull << 20))
+			for (auto it = doc.chunk; not br::eof(it); it = br::next_byte(it))
+				bytes = br::push(bytes, (char)br::as_byte(it));
+
+		const auto sv = br::make_sv(bytes.data, br::length(bytes));
+
+		auto cps = br::reserve(br::make_vec<br::char_t>(), length(sv));
+		auto out = br::reserve(br::make_vec<char>(), length(sv) * 4);
+
+		const auto decode_scalar = br::bench(5, [&] {
+			auto dest = cps.data;
+
+			for (auto ptr = sv.begin; ptr != sv.end;) {
+				const auto len = br::utf_char_length(ptr);
+				*dest++ = br::utf_char_decode(ptr, len);
+				ptr += len;
+			}
+
+			cps.used = dest - cps.data;
+			br::keep(cps.used);
+		});
+
+		const auto decode = br::bench(5, [&] {
+			cps.used = br::utf_decode(sv, cps.data);
+			br::keep(cps.used);
+		});
+
+		const auto encode_scalar = br::bench(5, [&] {
+			auto dest = out.data;
+
+			for (br::index_t i = 0; i != br::length(cps); ++i)
+				dest += br::utf_char_encode(cps.data[i], dest);
+
+			br::keep(dest);
+		});
+
+		const auto encode = br::bench(5, [&] {
+			br::keep(br::utf_encode(cps.data, br::length(cps), out.data));
+		});
+
+		std::printf("%s\n", doc.name);
+		br::report("  utf_decode (scalar)", decode_scalar, br::length(sv));
+		br::report("  utf_decode", decode, br::length(sv));
+		br::report("  utf_encode (scalar)", encode_scalar, br::length(sv));
+		br::report("  utf_encode", encode, br::length(sv));
+
+		out = br::destroy_vec(out);
+		cps = br::destroy_vec(cps);
+		bytes = br::destroy_vec(bytes);
+	}
+
+	return br::EXIT_SUCCESS;
+}
@@ -0,0 +1,291 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/str.hpp>
+#include <lib/vec.hpp>
+#include <lib/unicode.hpp>
+
+#include "bench.hpp"
+
+// The old generated predicates were chains of range comparisons.
+// They're generated separately (`unicode.py --chains`) so we can
+// compare against them.
+namespace chains {
+	using br::char_t;
+	#include "unicode_chains_internal.hpp"
+}
+
+// Classify every codepoint of a multilingual document with the
+// table lookups and with the old comparison chains.
+int main(int argc, const char* argv[]) {
+	constexpr br::str_view corpus[] = {
+		cstr("The quick brown fox jumps over the lazy dog, 1234567890! "),
+		cstr("Γαζέες καὶ μυρτιὲς δὲν θὰ βρῶ πιὰ στὸ χρυσαφὶ ξέφωτο. "),
+		cstr("Съешь же ещё этих мягких французских булок, да выпей чаю. "),
+		cstr("我能吞下玻璃而不伤身体。日本語の文章、カタカナとひらがな。 "),
+		cstr("نص حكيم له سر قاطع وذو شأن عظيم مكتوب على ثوب أخضر. "),
+		cstr("ऋषियों को सताने वाले दुष्ट राक्षसों के राजा रावण का सर्वनाश। "),
+		cstr("키스의 고유조건은 입술끼리 만나야 하고 특별한 기술은 필요치 않다. "),
+		cstr("∀x ∈ ℝ: x² ≥ 0 → √x² = |x| 😀🎉 € £ ¥ "),
+	};
+
+	auto cps = br::make_vec<br::char_t>();
+
+	while (br::length(cps) < (1ull << 22))
+		for (auto sv: corpus)
+			cps = br::utf_decode(sv, cps);
+
+	const auto run = [&] (const char* name, auto fn) {
+		const auto n = br::length(cps);
+		const auto ns = br::bench(5, [&] {
+			br::size_t count = 0;
+
+			for (br::index_t i = 0; i != n; ++i)
+				count += fn(cps.data[i]);
+
+			br::keep(count);
+		});
+
+		br::report(name, ns, n * sizeof(br::char_t));
+	};
+
+	run("is_lo (table)", [] (br::char_t c) { return br::is_lo(c); });
+	run("is_lo (chain)", [] (br::char_t c) { return chains::is_lo(c); });
+
+	run("is_so (table)", [] (br::char_t c) { return br::is_so(c); });
+	run("is_so (chain)", [] (br::char_t c) { return chains::is_so(c); });
+
+	run("is_letter (table)", [] (br::char_t c) { return br::is_letter(c); });
+	run("is_letter (chain)", [] (br::char_t c) {
+		return chains::is_lu(c) or chains::is_ll(c) or chains::is_lt(c) or chains::is_lm(c) or chains::is_lo(c);
+	});
+
+	run("is_punctuation (table)", [] (br::char_t c) { return br::is_punctuation(c); });
+	run("is_punctuation (chain)", [] (br::char_t c) {
+		return
+			chains::is_pc(c) or chains::is_pd(c) or chains::is_ps(c) or chains::is_pe(c) or
+			chains::is_pi(c) or chains::is_pf(c) or chains::is_po(c);
+	});
+
+	run("is_visible (table)", [] (br::char_t c) { return br::is_visible(c); });
+	run("is_visible (chain)", [] (br::char_t c) {
+		return
+			chains::is_lu(c) or chains::is_ll(c) or chains::is_lt(c) or chains::is_lm(c) or chains::is_lo(c) or
+			chains::is_nd(c) or chains::is_nl(c) or chains::is_no(c) or
+			chains::is_sm(c) or chains::is_sc(c) or chains::is_sk(c) or chains::is_so(c) or
+			chains::is_pc(c) or chains::is_pd(c) or chains::is_ps(c) or chains::is_pe(c) or
+			chains::is_pi(c) or chains::is_pf(c) or chains::is_po(c);
+	});
+
+	run("is_xid_continue (bitmap)", [] (br::char_t c) { return br::is_xid_continue(c); });
+	run("is_xid_continue (chain)", [] (br::char_t c) {
+		return
+			chains::is_lu(c) or chains::is_ll(c) or chains::is_lt(c) or chains::is_lm(c) or chains::is_lo(c) or
+			chains::is_nl(c) or chains::is_mn(c) or chains::is_mc(c) or chains::is_nd(c) or chains::is_pc(c);
+	});
+
+	// Mostly ASCII, like LaTeX-ish source.
+	cps.used = 0;
+
+	while (br::length(cps) < (1ull << 22))
+		cps = br::utf_decode(cstr("\\section{Intro} Some text with \\emph{macros}, maths $x^2 + y_i$ and a Γ. "), cps);
+
+	run("is_visible (table, ascii)", [] (br::char_t c) { return br::is_visible(c); });
+	run("is_whitespace (table, ascii)", [] (br::char_t c) { return br::is_whitespace(c); });
+	run("is_whitespace (chain, ascii)", [] (br::char_t c) {
+		return chains::is_zs(c) or chains::is_cc(c) or chains::is_cf(c);
+	});
+
+	// Tokenize identifiers and whitespace runs in bulk against a
+	// loop over `is_*` predicates.
+	constexpr br::str_view source[] = {
+		cstr("\\section{Introduction} some_text with \\emph{macros} "),
+		cstr("Γαζέες καὶ μυρτιὲς \\textbf{δὲν} θὰ "),
+		cstr("x_1 + y_2 = z "),
+	};
+
+	auto doc = br::make_vec<char>();
+
+	while (br::length(doc) < (4ull << 20))
+		for (auto sv: source)
+			for (auto it = sv; not br::eof(it); it = br::next_byte(it))
+				doc = br::push(doc, (char)br::as_byte(it));
+
+	const auto text = br::make_sv(doc.data, br::length(doc));
+	constexpr br::property_t ident = br::PROPERTY_ALPHANUMERIC | br::PROPERTY_PUNCTUATION;
+
+	const auto tokens_scalar = br::bench(5, [&] {
+		br::size_t count = 0;
+
+		for (auto it = text; not br::eof(it); count++) {
+			while (not br::eof(it) and br::has_property(br::as_char(it), ident))
+				it = br::next_char(it);
+
+			while (not br::eof(it) and not br::has_property(br::as_char(it), ident))
+				it = br::next_char(it);
+		}
+
+		br::keep(count);
+	});
+
+	const auto tokens_bulk = br::bench(5, [&] {
+		br::size_t count = 0;
+
+		for (auto it = text; not br::eof(it); count++) {
+			it = br::span_while(it, ident);
+			it = br::span_while(it, (br::property_t)~ident);
+		}
+
+		br::keep(count);
+	});
+
+	br::report("tokenize (per codepoint)", tokens_scalar, br::length(text));
+	br::report("tokenize (span_while)", tokens_bulk, br::length(text));
+
+	auto props = br::make_vec<br::property_t>();
+	props = br::reserve(props, br::length(text));
+
+	const auto classify = br::bench(5, [&] {
+		br::keep(br::classify(text, props.data));
+	});
+
+	br::report("classify", classify, br::length(text));
+
+	// Case mapping and caseless comparison.
+	auto lower = br::make_vec<char>();
+	lower = br::reserve(lower, br::length(text) * 2);
+
+	const auto to_lower_bulk = br::bench(5, [&] {
+		lower.used = 0;
+		lower = br::to_lower(text, lower);
+	});
+
+	const auto to_lower_scalar = br::bench(5, [&] {
+		lower.used = 0;
+
+		for (auto it = text; not br::eof(it);) {
+			br::char_t c;
+			it = br::iter_next_char(it, c);
+			lower.used += br::utf_char_encode(br::to_lower(c), lower.data + lower.used);
+		}
+	});
+
+	br::report("to_lower (per codepoint)", to_lower_scalar, br::length(text));
+	br::report("to_lower (bulk)", to_lower_bulk, br::length(text));
+
+	auto upper = br::to_upper(text);
+	const auto upper_text = br::make_sv(upper.data, br::length(upper));
+
+	const auto eq_fold_scalar = br::bench(5, [&] {
+		bool eq = true;
+		auto a = text;
+		auto b = upper_text;
+
+		while (eq and not br::eof(a) and not br::eof(b)) {
+			br::char_t x, y;
+			a = br::iter_next_char(a, x);
+			b = br::iter_next_char(b, y);
+			eq = br::fold_case(x) == br::fold_case(y);
+		}
+
+		br::keep(eq);
+	});
+
+	const auto eq_fold_bulk = br::bench(5, [&] {
+		br::keep(br::eq_fold(text, upper_text));
+	});
+
+	br::report("eq_fold (per codepoint)", eq_fold_scalar, br::length(text));
+	br::report("eq_fold", eq_fold_bulk, br::length(text));
+
+	// NFC normalization of text that is already normalized against
+	// normalizing all of it, and of the same text decomposed.
+	auto normalized = br::make_vec<char>();
+	auto scratch = br::make_vec<br::char_t>();
+
+	const auto nfc_quick = br::bench(5, [&] {
+		br::str_view out;
+		normalized.used = 0;
+		normalized = br::nfc(text, normalized, out);
+		br::keep(out);
+	});
+
+	const auto nfc_full = br::bench(5, [&] {
+		normalized.used = 0;
+		normalized = br::detail::nfc_run(text, normalized, scratch);
+	});
+
+	cps.used = 0;
+
+	for (auto it = text; not br::eof(it);) {
+		br::char_t c;
+		it = br::iter_next_char(it, c);
+		cps = br::detail::decompose(c, cps);
+	}
+
+	auto decomposed = br::utf_encode(cps, br::make_vec<char>());
+	const auto decomposed_text = br::make_sv(decomposed.data, br::length(decomposed));
+
+	const auto nfc_decomposed = br::bench(5, [&] {
+		br::str_view out;
+		normalized.used = 0;
+		normalized = br::nfc(decomposed_text, normalized, out);
+		br::keep(out);
+	});
+
+	br::report("nfc (normalize everything)", nfc_full, br::length(text));
+	br::report("nfc (quick check)", nfc_quick, br::length(text));
+	br::report("nfc (decomposed input)", nfc_decomposed, br::length(decomposed_text));
+
+	// Counting grapheme clusters against counting codepoints.
+	const auto codepoints = br::bench(5, [&] {
+		br::keep(br::utf_length(text));
+	});
+
+	const auto graphemes_iter = br::bench(5, [&] {
+		br::size_t count = 0;
+
+		for (auto it = text; not br::eof(it); it = br::next_grapheme(it))
+			count++;
+
+		br::keep(count);
+	});
+
+	const auto graphemes_bulk = br::bench(5, [&] {
+		br::keep(br::grapheme_length(text));
+	});
+
+	br::report("utf_length", codepoints, br::length(text));
+	br::report("next_grapheme", graphemes_iter, br::length(text));
+	br::report("grapheme_length", graphemes_bulk, br::length(text));
+
+	// Display width.
+	const auto width_scalar = br::bench(5, [&] {
+		br::size_t width = 0;
+
+		for (auto it = text; not br::eof(it);) {
+			br::char_t c;
+			it = br::iter_next_char(it, c);
+			width += br::display_width(c);
+		}
+
+		br::keep(width);
+	});
+
+	const auto width_bulk = br::bench(5, [&] {
+		br::keep(br::display_width(text));
+	});
+
+	br::report("display_width (per codepoint)", width_scalar, br::length(text));
+	br::report("display_width (bulk)", width_bulk, br::length(text));
+
+	decomposed = br::destroy_vec(decomposed);
+	scratch = br::destroy_vec(scratch);
+	normalized = br::destroy_vec(normalized);
+	upper = br::destroy_vec(upper);
+	lower = br::destroy_vec(lower);
+	props = br::destroy_vec(props);
+	doc = br::destroy_vec(doc);
+	cps = br::destroy_vec(cps);
+
+	return br::EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/str.hpp>
+#include <lib/vec.hpp>
+
+#include "bench.hpp"
+
+// Random access by codepoint with and without a `utf_index`
+// at several strides over a ~4 MiB mixed ASCII/UTF-8 document.
+int main(int argc, const char* argv[]) {
+	constexpr auto chunk = cstr("\\section{Γαζέες} some plain ascii text with a € sign and 😀 ");
+	constexpr size_t lookups = 256;
+
+	auto doc = br::make_vec<char>();
+
+	while (br::length(doc) < (4ull << 20))
+		for (auto it = chunk; not br::eof(it); it = br::next_byte(it))
+			doc = br::push(doc, (char)br::as_byte(it));
+
+	const auto sv = br::make_sv(doc.data, br::length(doc));
+	const auto n = br::utf_length(sv);
+
+	// Spread lookups evenly across the document.
+	const auto linear = br::bench(1, [&] {
+		for (br::index_t i = 0; i != lookups; ++i)
+			br::keep(br::char_at(sv, (i * 7919) % n));
+	});
+
+	br::report("char_at (linear)", linear);
+
+	const br::size_t strides[] = { 16, 64, 256, 1024 };
+
+	for (auto stride: strides) {
+		br::utf_index idx;
+
+		const auto build = br::bench(3, [&] {
+			idx = br::destroy_utf_index(idx);
+			idx = br::make_utf_index(sv, stride);
+		});
+
+		const auto indexed = br::bench(3, [&] {
+			for (br::index_t i = 0; i != lookups; ++i)
+				br::keep(br::char_at(idx, (i * 7919) % n));
+		});
+
+		std::printf("stride %-5lu index %8lu KiB\n", (unsigned long)stride, (unsigned long)(br::capacity(idx.offsets) * sizeof(br::index_t) / 1024));
+		br::report("  make_utf_index", build, br::length(sv));
+		br::report("  char_at (indexed)", indexed);
+
+		idx = br::destroy_utf_index(idx);
+	}
+
+	doc = br::destroy_vec(doc);
+
+	return br::EXIT_SUCCESS;
+}
@@ -14,12 +14,17 @@ UNICODE_HPP=src/lib/unicode_internal.hpp
 UNICODE_GEN=$(wildcard unicode/*)
 UNICODE_DATA=unicode/UnicodeData.txt
 UNICODE_PY=unicode/unicode.py
+UNICODE_CHAINS_HPP=bench/unicode_chains_internal.hpp
 
 # Testing
 TEST_FILE=test_cases
 TEST_DIR=test
 TEST_TARGET=$(basename $(subst $(TEST_DIR),$(BUILD_DIR),$(wildcard $(TEST_DIR)/*.cpp)))
 
+# Benchmarks (run with `make bench debug=no`)
+BENCH_DIR=bench
+BENCH_TARGET=$(basename $(subst $(BENCH_DIR)/,$(BUILD_DIR)/$(BENCH_DIR)/,$(wildcard $(BENCH_DIR)/*.cpp)))
+
 # Libraries to include and link
 INC=-Isrc/
 LIBS=$(LDLIBS)
@@ -46,3 +51,14 @@ else
 $(error sanitizer should be either yes or no)
 endif
 
+# Allocation statistics (printed to stderr at exit)
+alloc_stats ?= no
+
+ifeq ($(alloc_stats),yes)
+	CPPFLAGS+=-DBR_ALLOC_STATS
+else ifeq ($(alloc_stats),no)
+
+else
+$(error alloc_stats should be either yes or no)
+endif
+
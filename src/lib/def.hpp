@@ -39,7 +39,7 @@ namespace br {
 
 	// 8
 	template <> constexpr u8_t limit_max<u8_t>() { return UCHAR_MAX; }
-	template <> constexpr i8_t limit_max<i8_t>() { return SCHAR_MIN; }
+	template <> constexpr i8_t limit_max<i8_t>() { return SCHAR_MAX; }
 
 	template <> constexpr u8_t limit_min<u8_t>() { return 0; }
 	template <> constexpr i8_t limit_min<i8_t>() { return SCHAR_MIN; }
@@ -173,6 +173,21 @@ namespace br {
 	#endif
 
 
+	// Detect SIMD extensions.
+	// BR_DISABLE_SIMD => Use the portable scalar/SWAR paths only.
+	#define BR_SIMD_NONE
+
+	#if !defined(BR_DISABLE_SIMD) && defined(__SSE4_2__)
+		#define BR_SIMD_SSE42
+		#undef BR_SIMD_NONE
+	#endif
+
+	#if !defined(BR_DISABLE_SIMD) && defined(__AVX2__)
+		#define BR_SIMD_AVX2
+		#undef BR_SIMD_NONE
+	#endif
+
+
 	// Utility macros.
 	// Stringify a macro def.
 	// i.e. BR_STR(__LINE__) => "42" as opposed to "__LINE__"
@@ -213,6 +228,17 @@ namespace br {
 	constexpr size_t PATH_MAXIMUM_LENGTH = 4096;
 	constexpr size_t HELP_STR_LENGTH = 4096;
 	constexpr size_t USAGE_STR_LENGTH = 2048;
+	constexpr size_t UTF_INDEX_STRIDE = 64;
+	constexpr size_t INTERN_BLOCK_LENGTH = 64 * 1024;
+	constexpr size_t ARENA_CHUNK_LENGTH = 64 * 1024;
+	constexpr size_t ARENA_CHUNK_MAXIMUM_LENGTH = 4 * 1024 * 1024;
+	constexpr size_t POOL_SLAB_LENGTH = 64 * 1024;
+	constexpr size_t POOL_CACHE_LENGTH = 64;
+	constexpr size_t ALLOC_STATS_SITES = 512;
+	constexpr size_t MAP_THRESHOLD_LENGTH = 4 * 1024 * 1024;
+	constexpr size_t MAP_RESERVE_LENGTH = 1024 * 1024 * 1024;
+	constexpr size_t MAP_COMMIT_LENGTH = 2 * 1024 * 1024;
+	constexpr size_t ALLOC_STATS_BUCKETS = 32;
 
 }
 
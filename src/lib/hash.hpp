@@ -0,0 +1,123 @@
+#ifndef BR_HASH_H
+#define BR_HASH_H
+
+#include <lib/def.hpp>
+#include <lib/misc.hpp>
+#include <lib/simd.hpp>
+#include <lib/str.hpp>
+
+// 64 bit string hashing.
+// This is wyhash (final version 4) which hashes 48 bytes per
+// iteration using 64x64 => 128 bit multiplies and passes SMHasher.
+// The same function runs at compile time and at runtime so that
+// `"name"_h` literals agree with `br::hash` on runtime strings.
+// Hashes are stable across runs but not across library versions so
+// don't persist them.
+
+namespace br {
+
+	constexpr u64_t HASH_DEFAULT_SEED = 0;
+
+	namespace detail {
+		constexpr u64_t INTERNAL_HASH_SECRET__[] = {
+			0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+			0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+		};
+
+		// Read a little endian word. At compile time we can't
+		// reinterpret bytes so assemble it one byte at a time.
+		template <typename T>
+		constexpr u64_t hash_read(const char* const ptr) {
+			if (not is_constant_evaluated())
+				return load<T>(ptr);
+
+			u64_t x = 0;
+
+			for (index_t i = 0; i != sizeof(T); ++i)
+				x |= (u64_t)(u8_t)ptr[i] << (i * 8);
+
+			return x;
+		}
+
+		// Read 1 to 3 bytes spread over the input.
+		constexpr u64_t hash_read3(const char* const ptr, size_t n) {
+			return
+				((u64_t)(u8_t)ptr[0] << 16) |
+				((u64_t)(u8_t)ptr[n >> 1] << 8) |
+				(u64_t)(u8_t)ptr[n - 1];
+		}
+
+		// Multiply and fold the 128 bit product.
+		constexpr u64_t hash_mix(u64_t a, u64_t b) {
+			const auto r = mul_full(a, b);
+			return r.low ^ r.high;
+		}
+	}
+
+
+	constexpr u64_t hash(str_view sv, u64_t seed = HASH_DEFAULT_SEED) {
+		constexpr auto& s = detail::INTERNAL_HASH_SECRET__;
+
+		const char* ptr = sv.begin;
+		const size_t n = length(sv);
+
+		seed ^= detail::hash_mix(seed ^ s[0], s[1]);
+
+		u64_t a = 0;
+		u64_t b = 0;
+
+		if (n <= 16) {
+			if (n >= 4) {
+				const size_t mid = (n >> 3) << 2;
+
+				a = (detail::hash_read<u32_t>(ptr) << 32) | detail::hash_read<u32_t>(ptr + mid);
+				b = (detail::hash_read<u32_t>(ptr + n - 4) << 32) | detail::hash_read<u32_t>(ptr + n - 4 - mid);
+			}
+
+			else if (n > 0)
+				a = detail::hash_read3(ptr, n);
+		}
+
+		else {
+			size_t i = n;
+
+			// Three independent lanes to hide multiply latency.
+			if (i >= 48) {
+				u64_t lane1 = seed;
+				u64_t lane2 = seed;
+
+				do {
+					seed  = detail::hash_mix(detail::hash_read<u64_t>(ptr)      ^ s[1], detail::hash_read<u64_t>(ptr + 8)  ^ seed);
+					lane1 = detail::hash_mix(detail::hash_read<u64_t>(ptr + 16) ^ s[2], detail::hash_read<u64_t>(ptr + 24) ^ lane1);
+					lane2 = detail::hash_mix(detail::hash_read<u64_t>(ptr + 32) ^ s[3], detail::hash_read<u64_t>(ptr + 40) ^ lane2);
+
+					ptr += 48;
+					i -= 48;
+				} while (i >= 48);
+
+				seed ^= lane1 ^ lane2;
+			}
+
+			for (; i > 16; i -= 16, ptr += 16)
+				seed = detail::hash_mix(detail::hash_read<u64_t>(ptr) ^ s[1], detail::hash_read<u64_t>(ptr + 8) ^ seed);
+
+			// Last 16 bytes, overlapping what we've already consumed.
+			a = detail::hash_read<u64_t>(ptr + i - 16);
+			b = detail::hash_read<u64_t>(ptr + i - 8);
+		}
+
+		const auto r = detail::mul_full(a ^ s[1], b ^ seed);
+		return detail::hash_mix(r.low ^ s[0] ^ n, r.high ^ s[1]);
+	}
+
+}
+
+
+// Hash a string literal at compile time.
+// i.e. `switch (br::hash(name)) { case "section"_h: ... }`
+constexpr br::u64_t operator""_h(const char* const str, size_t n) {
+	return br::hash(br::make_sv(str, n));
+}
+
+#endif
+
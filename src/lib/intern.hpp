@@ -0,0 +1,223 @@
+#ifndef BR_INTERN_H
+#define BR_INTERN_H
+
+#include <lib/def.hpp>
+#include <lib/assert.hpp>
+#include <lib/misc.hpp>
+#include <lib/mem.hpp>
+#include <lib/vec.hpp>
+#include <lib/str.hpp>
+#include <lib/hash.hpp>
+
+// String interning.
+// Deduplicates strings into dense `symbol_t` ids so that comparing
+// identifiers is an integer compare and per-symbol data can live
+// in a flat array indexed by id.
+// Strings are copied into an arena which never moves them so views
+// returned by `symbol_name` stay valid until the interner is
+// destroyed.
+// Lookup is an open addressing table with linear probing. Each slot
+// keeps the top 32 bits of the hash so most mismatches are rejected
+// without touching the string.
+
+namespace br {
+
+	using symbol_t = u32_t;
+
+	constexpr symbol_t NO_SYMBOL = limit_max<symbol_t>();
+
+
+	struct interner {
+		struct slot {
+			u32_t tag = 0;
+			symbol_t id = NO_SYMBOL;
+		};
+
+		slot* slots = nullptr;
+		size_t mask = 0;  // Table capacity - 1.
+
+		vec<str_view> names;  // Indexed by symbol.
+		arena strings;
+	};
+
+
+	namespace detail {
+		// Capacity needed to keep the load factor below 3/4.
+		constexpr size_t intern_capacity(size_t count) {
+			size_t cap = 16;
+
+			while (cap * 3 < count * 4)
+				cap *= 2;
+
+			return cap;
+		}
+
+		[[nodiscard]] inline interner intern_rehash(interner in, size_t cap) {
+			auto slots = br::alloc<interner::slot>(cap);
+
+			for (index_t i = 0; i != cap; ++i)
+				slots[i] = {};
+
+			// Reinsert existing symbols. They are all unique so no
+			// string comparisons are needed.
+			for (index_t i = 0; i != in.mask + 1 and in.slots; ++i) {
+				const auto s = in.slots[i];
+
+				if (s.id == NO_SYMBOL)
+					continue;
+
+				index_t j = hash(at(in.names, s.id)) & (cap - 1);
+
+				while (slots[j].id != NO_SYMBOL)
+					j = (j + 1) & (cap - 1);
+
+				slots[j] = s;
+			}
+
+			br::free(in.slots);
+
+			in.slots = slots;
+			in.mask = cap - 1;
+
+			return in;
+		}
+
+		// Copy a string into the arena.
+		[[nodiscard]] inline interner intern_copy(interner in, str_view sv, str_view& out) {
+			const size_t n = length(sv);
+
+			char* ptr;
+			in.strings = arena_alloc(in.strings, n, ptr);
+
+			std::memcpy(ptr, sv.begin, n);
+			out = make_sv(ptr, n);
+
+			return in;
+		}
+	}
+
+
+	// Make an interner with room for `count` symbols before it
+	// needs to grow.
+	[[nodiscard]] inline interner make_interner(size_t count = 0) {
+		interner in;
+
+		in.names = make_vec<str_view>();
+		in.strings = make_arena(INTERN_BLOCK_LENGTH);
+
+		return detail::intern_rehash(in, detail::intern_capacity(count));
+	}
+
+	[[nodiscard]] inline interner destroy_interner(interner in) {
+		br::free(in.slots);
+
+		in.names = destroy_vec(in.names);
+		in.strings = destroy_arena(in.strings);
+
+		return {};
+	}
+
+
+	// Number of unique symbols.
+	inline size_t length(const interner& in) {
+		return length(in.names);
+	}
+
+	// Bytes allocated for the arena, table and symbol array.
+	inline size_t memory_footprint(const interner& in) {
+		return
+			memory_footprint(in.strings) +
+			(in.mask + 1) * sizeof(interner::slot) +
+			capacity(in.names) * sizeof(str_view);
+	}
+
+
+	// Find the symbol for a string without inserting it.
+	// Returns `NO_SYMBOL` if it hasn't been interned.
+	inline symbol_t find_symbol(const interner& in, str_view sv) {
+		const u64_t h = hash(sv);
+		const u32_t tag = h >> 32;
+
+		for (index_t i = h & in.mask;; i = (i + 1) & in.mask) {
+			const auto s = in.slots[i];
+
+			if (s.id == NO_SYMBOL)
+				return NO_SYMBOL;
+
+			if (s.tag == tag and eq(at(in.names, s.id), sv))
+				return s.id;
+		}
+	}
+
+	// Get the string a symbol was interned from.
+	inline str_view symbol_name(const interner& in, symbol_t id) {
+		BR_ASSERT(id < length(in.names));
+		return in.names.data[id];
+	}
+
+
+	// Intern a string, storing its symbol in `id`.
+	// The string is only copied the first time it is seen.
+	[[nodiscard]] inline interner intern(interner in, str_view sv, symbol_t& id) {
+		const u64_t h = hash(sv);
+		const u32_t tag = h >> 32;
+
+		index_t i = h & in.mask;
+
+		for (;; i = (i + 1) & in.mask) {
+			const auto s = in.slots[i];
+
+			if (s.id == NO_SYMBOL)
+				break;
+
+			if (s.tag == tag and eq(at(in.names, s.id), sv)) {
+				id = s.id;
+				return in;
+			}
+		}
+
+		BR_ASSERT(length(in.names) < NO_SYMBOL);
+
+		str_view copy;
+		in = detail::intern_copy(in, sv, copy);
+
+		id = length(in.names);
+		in.names = push(in.names, copy);
+		in.slots[i] = { tag, id };
+
+		if (detail::intern_capacity(length(in.names)) > in.mask + 1)
+			in = detail::intern_rehash(in, (in.mask + 1) * 2);
+
+		return in;
+	}
+
+	// Intern many strings at once, e.g. built-in macro names at
+	// startup. The table is grown once up front rather than
+	// repeatedly as the strings are inserted. Symbols are written
+	// to `ids` if it isn't null.
+	[[nodiscard]] inline interner intern(interner in, const str_view* const svs, size_t n, symbol_t* const ids = nullptr) {
+		const size_t cap = detail::intern_capacity(length(in.names) + n);
+
+		if (cap > in.mask + 1)
+			in = detail::intern_rehash(in, cap);
+
+		for (index_t i = 0; i != n; ++i) {
+			symbol_t id;
+			in = intern(in, svs[i], id);
+
+			if (ids)
+				ids[i] = id;
+		}
+
+		return in;
+	}
+
+	template <size_t N>
+	[[nodiscard]] inline interner intern(interner in, const str_view(&svs)[N], symbol_t* const ids = nullptr) {
+		return intern(in, svs, N, ids);
+	}
+
+}
+
+#endif
+
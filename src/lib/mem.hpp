@@ -1,56 +1,509 @@
 #ifndef BR_MEM_H
 #define BR_MEM_H
 
+#include <cstdio>
 #include <cstdlib>
+#include <cstddef>
+#include <cstring>
 #include <lib/def.hpp>
 #include <lib/assert.hpp>
+#include <lib/trait.hpp>
+#include <lib/simd.hpp>
+
+#ifdef BR_PLATFORM_LINUX
+	#include <sys/mman.h>
+#endif
 
 namespace br {
 
+	// Bulk copies and fills.
+	// Sizes below 32 bytes are handled with a few overlapping loads
+	// and stores from both ends so they need no loop. Larger ones
+	// load the first and last vector up front, then copy the middle
+	// with aligned stores. Everything is loaded before the stores
+	// that could overwrite it so the same kernels serve `memmove`
+	// as long as they run in the right direction.
+	namespace detail {
+	#if defined(BR_SIMD_AVX2)
+		struct mem_vector {
+			using type = __m256i;
+			static constexpr size_t size = 32;
+
+			static type load(const char* const ptr) { return _mm256_loadu_si256((const __m256i*)ptr); }
+			static void store(char* const ptr, type x) { _mm256_storeu_si256((__m256i*)ptr, x); }
+			static void store_aligned(char* const ptr, type x) { _mm256_store_si256((__m256i*)ptr, x); }
+			static type broadcast(u8_t b) { return _mm256_set1_epi8(b); }
+		};
+
+	#elif defined(BR_SIMD_SSE42)
+		struct mem_vector {
+			using type = __m128i;
+			static constexpr size_t size = 16;
+
+			static type load(const char* const ptr) { return _mm_loadu_si128((const __m128i*)ptr); }
+			static void store(char* const ptr, type x) { _mm_storeu_si128((__m128i*)ptr, x); }
+			static void store_aligned(char* const ptr, type x) { _mm_store_si128((__m128i*)ptr, x); }
+			static type broadcast(u8_t b) { return _mm_set1_epi8(b); }
+		};
+
+	#else
+		struct mem_vector {
+			using type = u64_t;
+			static constexpr size_t size = 8;
+
+			static type load(const char* const ptr) { return br::load<u64_t>(ptr); }
+			static void store(char* const ptr, type x) { br::store(ptr, x); }
+			static void store_aligned(char* const ptr, type x) { br::store(ptr, x); }
+			static type broadcast(u8_t b) { return swar_broadcast(b); }
+		};
+	#endif
+
+		constexpr size_t MEM_SMALL = 32;
+
+		// Copy fewer than `MEM_SMALL` bytes.
+		inline void copy_small(const char* const src, char* const dest, size_t n) {
+			if (n >= 16) {
+				const u64_t a = load<u64_t>(src);
+				const u64_t b = load<u64_t>(src + 8);
+				const u64_t c = load<u64_t>(src + n - 16);
+				const u64_t d = load<u64_t>(src + n - 8);
+
+				store(dest, a);
+				store(dest + 8, b);
+				store(dest + n - 16, c);
+				store(dest + n - 8, d);
+			}
+
+			else if (n >= 8) {
+				const u64_t a = load<u64_t>(src);
+				const u64_t b = load<u64_t>(src + n - 8);
+
+				store(dest, a);
+				store(dest + n - 8, b);
+			}
+
+			else if (n >= 4) {
+				const u32_t a = load<u32_t>(src);
+				const u32_t b = load<u32_t>(src + n - 4);
+
+				store(dest, a);
+				store(dest + n - 4, b);
+			}
+
+			else if (n != 0) {
+				const char a = src[0];
+				const char b = src[n / 2];
+				const char c = src[n - 1];
+
+				dest[0] = a;
+				dest[n / 2] = b;
+				dest[n - 1] = c;
+			}
+		}
+
+		// Copy from the front. Safe if `dest` is before `src`.
+		inline void copy_forward(const char* const src, char* const dest, size_t n) {
+			using V = mem_vector;
+
+			if (n < MEM_SMALL)
+				return copy_small(src, dest, n);
+
+			const auto head = V::load(src);
+			const auto tail = V::load(src + n - V::size);
+
+			// Skip to the first aligned store after the head.
+			size_t i = V::size - ((ptr_t)dest & (V::size - 1));
+
+			for (; n - i > V::size * 4; i += V::size * 4) {
+				const auto a = V::load(src + i);
+				const auto b = V::load(src + i + V::size);
+				const auto c = V::load(src + i + V::size * 2);
+				const auto d = V::load(src + i + V::size * 3);
+
+				V::store_aligned(dest + i, a);
+				V::store_aligned(dest + i + V::size, b);
+				V::store_aligned(dest + i + V::size * 2, c);
+				V::store_aligned(dest + i + V::size * 3, d);
+			}
+
+			for (; n - i > V::size; i += V::size)
+				V::store_aligned(dest + i, V::load(src + i));
+
+			V::store(dest + n - V::size, tail);
+			V::store(dest, head);
+		}
+
+		// Copy from the back. Safe if `dest` is after `src`.
+		inline void copy_backward(const char* const src, char* const dest, size_t n) {
+			using V = mem_vector;
+
+			if (n < MEM_SMALL)
+				return copy_small(src, dest, n);
+
+			const auto head = V::load(src);
+			const auto tail = V::load(src + n - V::size);
+
+			// End of the last aligned store before the tail.
+			size_t i = n - ((ptr_t)(dest + n) & (V::size - 1));
+
+			if (i == n)
+				i -= V::size;
+
+			for (; i > V::size * 4; i -= V::size * 4) {
+				const auto a = V::load(src + i - V::size);
+				const auto b = V::load(src + i - V::size * 2);
+				const auto c = V::load(src + i - V::size * 3);
+				const auto d = V::load(src + i - V::size * 4);
+
+				V::store_aligned(dest + i - V::size, a);
+				V::store_aligned(dest + i - V::size * 2, b);
+				V::store_aligned(dest + i - V::size * 3, c);
+				V::store_aligned(dest + i - V::size * 4, d);
+			}
+
+			for (; i > V::size; i -= V::size)
+				V::store_aligned(dest + i - V::size, V::load(src + i - V::size));
+
+			V::store(dest, head);
+			V::store(dest + n - V::size, tail);
+		}
+
+		inline void fill_bytes(char* const dest, size_t n, u8_t b) {
+			using V = mem_vector;
+
+			if (n < MEM_SMALL) {
+				const u64_t x = swar_broadcast(b);
+
+				if (n >= 16) {
+					store(dest, x);
+					store(dest + 8, x);
+					store(dest + n - 16, x);
+					store(dest + n - 8, x);
+				}
+
+				else if (n >= 8) {
+					store(dest, x);
+					store(dest + n - 8, x);
+				}
+
+				else if (n >= 4) {
+					store(dest, (u32_t)x);
+					store(dest + n - 4, (u32_t)x);
+				}
+
+				else if (n != 0) {
+					dest[0] = b;
+					dest[n / 2] = b;
+					dest[n - 1] = b;
+				}
+
+				return;
+			}
+
+			const auto x = V::broadcast(b);
+
+			V::store(dest, x);
+
+			size_t i = V::size - ((ptr_t)dest & (V::size - 1));
+
+			for (; n - i > V::size * 4; i += V::size * 4) {
+				V::store_aligned(dest + i, x);
+				V::store_aligned(dest + i + V::size, x);
+				V::store_aligned(dest + i + V::size * 2, x);
+				V::store_aligned(dest + i + V::size * 3, x);
+			}
+
+			for (; n - i > V::size; i += V::size)
+				V::store_aligned(dest + i, x);
+
+			V::store(dest + n - V::size, x);
+		}
+	}
+
+
 	// Copy a region of memory to another (regions must not overlap)
 	template <typename T1, typename T2>
 	inline void memcpy(T1* src, T2* dest, size_t count) {
-		for (index_t i = 0; i < count; i++) {
-			*((char*)dest + i) = *((char*)src + i);
-		}
+		detail::copy_forward((const char*)src, (char*)dest, count);
 	}
 
+	// Copy a region of memory to another which may overlap it.
 	template <typename T1, typename T2>
 	inline void memmove(T1* src, T2* dest, size_t count) {
-		index_t i;
-		index_t end;
-		i32_t direction;
+		// `dest` before `src` or far enough after it not to overlap.
+		if ((ptr_t)dest - (ptr_t)src >= count)
+			detail::copy_forward((const char*)src, (char*)dest, count);
+
+		else
+			detail::copy_backward((const char*)src, (char*)dest, count);
+	}
+
 
-		if (dest > src) {
-			i = count;
-			end = 0;
-			direction = -1;
+	// Fill buffer with value.
+	// Byte sized values are broadcast and written with wide stores.
+	template <typename T, typename V>
+	inline void fill(T& arr, size_t count, V val) {
+		if constexpr (sizeof(arr[0]) == 1) {
+			const remove_cv_t<remove_reference_t<decltype(arr[0])>> x = val;
+			u8_t b;
+			std::memcpy(&b, &x, 1);
+
+			detail::fill_bytes((char*)&arr[0], count, b);
 		}
 
 		else {
-			i = 0;
-			end = count;
-			direction = 1;
+			for (index_t i = 0; i < count; i++) {
+				arr[i] = val;
+			}
+		}
+	}
+
+
+	namespace detail {
+		// Test-and-test-and-set spinlock for short critical sections.
+		inline void spin_lock(u32_t& lock) {
+			while (__atomic_exchange_n(&lock, 1, __ATOMIC_ACQUIRE))
+				while (__atomic_load_n(&lock, __ATOMIC_RELAXED))
+					;
 		}
 
-		for (; i != end; i += direction)
-			*((char*)dest + i) = *((char*)src + i);
+		inline void spin_unlock(u32_t& lock) {
+			__atomic_store_n(&lock, 0, __ATOMIC_RELEASE);
+		}
 	}
 
 
-	// Fill buffer with value.
-	template <typename T, typename V>
-	inline void fill(T& arr, size_t count, V val) {
-		for (index_t i = 0; i < count; i++) {
-			arr[i] = val;
+	// Where an allocation was asked for.
+	// Functions that allocate on behalf of their caller take one as
+	// their last parameter, defaulting to `alloc_site::current()`, and
+	// pass it on so that `alloc_stats=yes` reports the caller's line
+	// rather than their own. A default argument is evaluated where the
+	// call is written, so the outermost default wins.
+	// Without BR_ALLOC_STATS it is empty.
+	struct alloc_site {
+	#if defined(BR_ALLOC_STATS)
+		const char* file = "(unknown)";
+		u32_t line = 0;
+
+		static constexpr alloc_site current(const char* const file = __builtin_FILE(), u32_t line = __builtin_LINE()) {
+			return { file, line };
+		}
+	#else
+		static constexpr alloc_site current() {
+			return {};
+		}
+	#endif
+	};
+
+
+#if defined(BR_ALLOC_STATS)
+	// Allocation statistics.
+	// BR_ALLOC_STATS (`make alloc_stats=yes`) records every `br::alloc`
+	// and `br::free` against the `alloc_site` that asked for it and
+	// prints a summary to stderr at exit: calls, bytes, the live high
+	// water mark, blocks never freed and a histogram of request sizes.
+	// Each block carries a header with its size and call site. Blocks
+	// from `map_alloc` are counted the same way.
+	// Without BR_ALLOC_STATS none of this exists.
+	namespace detail {
+		struct alloc_site_stats {
+			const char* file = nullptr;
+			u32_t line = 0;
+
+			size_t calls = 0;
+			size_t bytes = 0;  // Total requested.
+			size_t live = 0;  // Bytes currently allocated.
+			size_t blocks = 0;  // Blocks currently allocated.
+			size_t peak = 0;  // Highest `live`.
+
+			size_t sizes[ALLOC_STATS_BUCKETS] {};  // Requests by power of two.
+		};
+
+		struct alloc_stats {
+			alloc_site_stats sites[ALLOC_STATS_SITES];
+
+			size_t calls = 0;
+			size_t frees = 0;
+			size_t bytes = 0;
+			size_t live = 0;
+			size_t peak = 0;
+
+			u32_t lock = 0;
+			bool registered = false;
+		};
+
+		inline alloc_stats INTERNAL_ALLOC_STATS__;
+
+		struct alignas(std::max_align_t) alloc_header {
+			size_t size;
+			u32_t site;
+		};
+
+		// Find or add the slot for a call site. The last slot
+		// collects everything once the table is full.
+		inline u32_t alloc_site_index(const char* const file, u32_t line) {
+			auto& sites = INTERNAL_ALLOC_STATS__.sites;
+			constexpr u32_t n = ALLOC_STATS_SITES - 1;
+
+			for (u32_t i = (line * 2654435761u) % n, probes = 0; probes != n; i = (i + 1) % n, ++probes) {
+				auto& s = sites[i];
+
+				if (s.file == nullptr) {
+					s.file = file;
+					s.line = line;
+					return i;
+				}
+
+				if (s.line == line and (s.file == file or std::strcmp(s.file, file) == 0))
+					return i;
+			}
+
+			sites[n].file = "(other)";
+			return n;
+		}
+
+		inline void alloc_release(u32_t site, size_t n) {
+			auto& st = INTERNAL_ALLOC_STATS__;
+
+			st.sites[site].live -= n;
+			st.sites[site].blocks--;
+			st.live -= n;
+		}
+
+		inline u32_t alloc_record(br::alloc_site site, size_t n) {
+			auto& st = INTERNAL_ALLOC_STATS__;
+
+			const u32_t i = alloc_site_index(site.file, site.line);
+			auto& s = st.sites[i];
+
+			s.calls++;
+			s.bytes += n;
+			s.live += n;
+			s.blocks++;
+			s.peak = max(s.peak, s.live);
+			s.sizes[min<size_t>(n ? 64 - countl_zero((u64_t)n) : 0, ALLOC_STATS_BUCKETS - 1)]++;
+
+			st.calls++;
+			st.bytes += n;
+			st.live += n;
+			st.peak = max(st.peak, st.live);
+
+			return i;
+		}
+	}
+
+
+	// Print the summary, sites with the highest peak first.
+	inline void print_alloc_stats() {
+		auto& st = detail::INTERNAL_ALLOC_STATS__;
+
+		u32_t order[ALLOC_STATS_SITES];
+		u32_t n = 0;
+
+		BR_SCOPE(detail::spin_lock(st.lock), detail::spin_unlock(st.lock)) {
+			for (u32_t i = 0; i != ALLOC_STATS_SITES; ++i) {
+				if (st.sites[i].calls == 0)
+					continue;
+
+				u32_t j = n++;
+
+				for (; j > 0 and st.sites[order[j - 1]].peak < st.sites[i].peak; --j)
+					order[j] = order[j - 1];
+
+				order[j] = i;
+			}
+
+			std::fprintf(stderr,
+				"alloc: %lu calls, %lu frees, %lu bytes, %lu peak, %lu leaked\n",
+				(unsigned long)st.calls, (unsigned long)st.frees, (unsigned long)st.bytes,
+				(unsigned long)st.peak, (unsigned long)st.live);
+
+			for (u32_t k = 0; k != n; ++k) {
+				const auto& s = st.sites[order[k]];
+
+				std::fprintf(stderr,
+					"[%s:%u] %lu calls, %lu bytes, %lu peak, %lu leaked in %lu blocks\n  sizes",
+					s.file, (unsigned)s.line, (unsigned long)s.calls, (unsigned long)s.bytes,
+					(unsigned long)s.peak, (unsigned long)s.live, (unsigned long)s.blocks);
+
+				// Bucket `b` starts at 2^(b-1) bytes.
+				for (index_t b = 0; b != ALLOC_STATS_BUCKETS; ++b)
+					if (s.sizes[b])
+						std::fprintf(stderr, " %lu+:%lu", (unsigned long)(b ? 1ul << (b - 1) : 0), (unsigned long)s.sizes[b]);
+
+				std::fputc('\n', stderr);
+			}
 		}
 	}
 
 
+	namespace detail {
+		// Count a new block of `n` bytes, or one grown from a block of
+		// `old_n` bytes recorded against `old_site`.
+		inline u32_t alloc_track(br::alloc_site site, size_t n, bool grown = false, u32_t old_site = 0, size_t old_n = 0) {
+			auto& st = INTERNAL_ALLOC_STATS__;
+			u32_t i;
+
+			BR_SCOPE(spin_lock(st.lock), spin_unlock(st.lock)) {
+				if (not st.registered) {
+					st.registered = true;
+					std::atexit(print_alloc_stats);
+				}
+
+				if (grown)
+					alloc_release(old_site, old_n);
+
+				i = alloc_record(site, n);
+			}
+
+			return i;
+		}
+
+		inline void alloc_untrack(u32_t site, size_t n) {
+			auto& st = INTERNAL_ALLOC_STATS__;
+
+			BR_SCOPE(spin_lock(st.lock), spin_unlock(st.lock)) {
+				alloc_release(site, n);
+				st.frees++;
+			}
+		}
+	}
+
+
+	// Allocate or expand a chunk of memory, recording the caller.
+	template <typename T>
+	inline T* alloc(size_t count = 1, T* old_ptr = nullptr, alloc_site site = alloc_site::current()) {
+		BR_ASSERT(count != 0); // UB if count is zero.
+
+		auto old = old_ptr ? (detail::alloc_header*)old_ptr - 1 : nullptr;
+		const auto [old_size, old_site] = old ? *old : detail::alloc_header {};
+		const size_t n = sizeof(T) * count;
+
+		auto h = static_cast<detail::alloc_header*>(std::realloc(old, sizeof(detail::alloc_header) + n));
+		BR_ASSERT(h != nullptr);
+
+		h->size = n;
+		h->site = detail::alloc_track(site, n, old != nullptr, old_site, old_size);
+
+		return (T*)(h + 1);
+	}
+
+	template <typename T>
+	inline void free(T* ptr) {
+		if (ptr == nullptr)
+			return;
+
+		auto h = (detail::alloc_header*)ptr - 1;
+		detail::alloc_untrack(h->site, h->size);
+
+		std::free(h);
+	}
+
+#else
 	// Allocate or expand a chunk of memory.
 	// Realloc acts like malloc when provided with nullptr.
 	template <typename T>
-	inline T* alloc(size_t count = 1, T* old_ptr = nullptr) {
+	inline T* alloc(size_t count = 1, T* old_ptr = nullptr, alloc_site site = alloc_site::current()) {
 		BR_ASSERT(count != 0); // UB if count is zero.
 		T* ptr = static_cast<T*>(std::realloc(old_ptr, sizeof(T) * count));
 		BR_ASSERT(ptr != nullptr);
@@ -61,6 +514,442 @@ namespace br {
 	inline void free(T* ptr) {
 		std::free(ptr);
 	}
+#endif
+
+
+	// Region allocator.
+	// Allocating bumps a pointer through large chunks and nothing is
+	// freed individually. Everything allocated since a mark is
+	// released at once by rewinding to it and the whole arena by
+	// destroying it. Memory is never moved so pointers stay valid
+	// until then.
+	// Chunks double in size up to `ARENA_CHUNK_MAXIMUM_LENGTH`.
+	// Requests bigger than a quarter of a chunk get a chunk of their
+	// own which is linked in without giving up the free space left
+	// in the current one.
+	struct arena_chunk {
+		arena_chunk* prev = nullptr;
+		size_t size = 0;  // Usable bytes following the header.
+	};
+
+	struct arena {
+		arena_chunk* chunk = nullptr;  // Most recently allocated chunk.
+
+		char* head = nullptr;  // Free space being bumped through.
+		char* tail = nullptr;
+
+		size_t chunk_length = ARENA_CHUNK_LENGTH;  // Size of the next chunk.
+		size_t bytes = 0;  // Allocated from the heap, including headers.
+	};
+
+	// Position to rewind to.
+	struct arena_mark {
+		arena_chunk* chunk = nullptr;
+		char* head = nullptr;
+		char* tail = nullptr;
+	};
+
+
+	namespace detail {
+		inline char* align_up(char* const ptr, size_t align) {
+			return (char*)(((ptr_t)ptr + align - 1) & ~(ptr_t)(align - 1));
+		}
+
+		inline char* chunk_data(arena_chunk* const c) {
+			return (char*)(c + 1);
+		}
+
+		[[nodiscard]] inline arena arena_push_chunk(arena a, size_t size, alloc_site site) {
+			// The header keeps chunk data as aligned as `br::alloc`.
+			BR_STATIC_ASSERT(sizeof(arena_chunk) % alignof(std::max_align_t) == 0);
+
+			auto c = (arena_chunk*)br::alloc<char>(sizeof(arena_chunk) + size, nullptr, site);
+
+			c->prev = a.chunk;
+			c->size = size;
+
+			a.chunk = c;
+			a.bytes += sizeof(arena_chunk) + size;
+
+			return a;
+		}
+
+		// Slow path of `arena_alloc` when the current chunk is full.
+		[[nodiscard]] inline arena arena_grow(arena a, size_t n, size_t align, char*& out, alloc_site site) {
+			const size_t need = n + align - 1;
+
+			if (need > a.chunk_length / 4) {
+				a = arena_push_chunk(a, need, site);
+				out = align_up(chunk_data(a.chunk), align);
+				return a;
+			}
+
+			a = arena_push_chunk(a, a.chunk_length, site);
+			a.chunk_length = min(a.chunk_length * 2, max(a.chunk_length, ARENA_CHUNK_MAXIMUM_LENGTH));
+
+			out = align_up(chunk_data(a.chunk), align);
+			a.head = out + n;
+			a.tail = chunk_data(a.chunk) + a.chunk->size;
+
+			return a;
+		}
+	}
+
+
+	// Make an arena whose first chunk is `length` bytes.
+	[[nodiscard]] inline arena make_arena(size_t length = ARENA_CHUNK_LENGTH, alloc_site site = alloc_site::current()) {
+		BR_ASSERT(length != 0);
+
+		arena a;
+		a.chunk_length = length;
+
+		char* ptr;
+		return detail::arena_grow(a, 0, 1, ptr, site);
+	}
+
+	// Release every chunk.
+	[[nodiscard]] inline arena destroy_arena(arena a) {
+		while (a.chunk) {
+			auto prev = a.chunk->prev;
+			br::free(a.chunk);
+			a.chunk = prev;
+		}
+
+		return {};
+	}
+
+
+	// Allocate `count` uninitialised elements, storing the pointer
+	// in `ptr`. `align` must be a power of two.
+	template <typename T>
+	[[nodiscard]] inline arena arena_alloc(arena a, size_t count, T*& ptr, size_t align = alignof(T), alloc_site site = alloc_site::current()) {
+		BR_ASSERT(align != 0 and (align & (align - 1)) == 0);
+
+		const size_t n = sizeof(T) * count;
+		char* p = detail::align_up(a.head, align);
+
+		if (a.head == nullptr or (ptr_t)p + n > (ptr_t)a.tail)
+			a = detail::arena_grow(a, n, align, p, site);
+
+		else
+			a.head = p + n;
+
+		ptr = (T*)p;
+		return a;
+	}
+
+
+	// Remember the current position.
+	inline arena_mark mark_arena(const arena& a) {
+		return { a.chunk, a.head, a.tail };
+	}
+
+	// Release everything allocated since `m` was taken.
+	// Marks taken after `m` are invalidated.
+	[[nodiscard]] inline arena rewind_arena(arena a, arena_mark m) {
+		while (a.chunk != m.chunk) {
+			BR_ASSERT(a.chunk != nullptr);
+
+			auto prev = a.chunk->prev;
+			a.bytes -= sizeof(arena_chunk) + a.chunk->size;
+
+			br::free(a.chunk);
+			a.chunk = prev;
+		}
+
+		a.head = m.head;
+		a.tail = m.tail;
+
+		return a;
+	}
+
+
+	// Bytes allocated from the heap.
+	inline size_t memory_footprint(const arena& a) {
+		return a.bytes;
+	}
+
+
+	// Large allocations.
+	// Blocks come straight from the kernel. Address space is reserved
+	// well beyond the requested size and only committed as the block
+	// grows so growing doesn't move it. Outgrowing the reservation
+	// moves the pages to a bigger one with `mremap` rather than
+	// copying them.
+	// Reservations are aligned to and committed in steps of
+	// `MAP_COMMIT_LENGTH`, the usual huge page size, and marked with
+	// `MADV_HUGEPAGE` so transparent huge pages can back them.
+	// Only Linux has this path. Elsewhere these are `br::alloc` and
+	// `br::free`.
+#ifdef BR_PLATFORM_LINUX
+	namespace detail {
+		// Lives in front of the block.
+		struct map_header {
+			size_t reserved;  // Bytes of address space, including the header.
+			size_t committed;
+
+		#if defined(BR_ALLOC_STATS)
+			size_t size;  // Bytes requested.
+			u32_t site;
+		#endif
+		};
+
+		constexpr size_t MAP_HEADER_LENGTH = 64;
+
+		constexpr size_t round_up(size_t n, size_t align) {
+			return (n + align - 1) & ~(align - 1);
+		}
+
+		inline map_header* map_header_of(void* const ptr) {
+			return (map_header*)((char*)ptr - MAP_HEADER_LENGTH);
+		}
+
+		inline char* map_reserve(size_t bytes) {
+			const size_t length = bytes + MAP_COMMIT_LENGTH;
+
+			auto ptr = (char*)mmap(nullptr, length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			BR_ASSERT(ptr != MAP_FAILED);
+
+			// Trim to a huge page boundary.
+			char* const base = align_up(ptr, MAP_COMMIT_LENGTH);
+			char* const end = base + bytes;
+
+			if (base != ptr)
+				munmap(ptr, base - ptr);
+
+			if (end != ptr + length)
+				munmap(end, ptr + length - end);
+
+		#ifdef MADV_HUGEPAGE
+			madvise(base, bytes, MADV_HUGEPAGE);
+		#endif
+
+			return base;
+		}
+
+		inline void map_commit(char* const base, size_t from, size_t to) {
+			[[maybe_unused]] const int r = mprotect(base + from, to - from, PROT_READ | PROT_WRITE);
+			BR_ASSERT(r == 0);
+		}
+	}
+
+
+	// Allocate or expand a block of `count` elements.
+	template <typename T>
+	[[nodiscard]] inline T* map_alloc(size_t count, T* old_ptr = nullptr, alloc_site site = alloc_site::current()) {
+		using detail::map_header;
+
+		const size_t need = detail::round_up(detail::MAP_HEADER_LENGTH + sizeof(T) * count, MAP_COMMIT_LENGTH);
+		map_header* const old = old_ptr ? detail::map_header_of(old_ptr) : nullptr;
+
+	#if defined(BR_ALLOC_STATS)
+		const size_t size = sizeof(T) * count;
+		const u32_t index = old ?
+			detail::alloc_track(site, size, true, old->site, old->size) :
+			detail::alloc_track(site, size);
+	#endif
+
+		if (old and need <= old->reserved) {
+			if (need > old->committed) {
+				detail::map_commit((char*)old, old->committed, need);
+				old->committed = need;
+			}
+
+		#if defined(BR_ALLOC_STATS)
+			old->size = size;
+			old->site = index;
+		#endif
+
+			return old_ptr;
+		}
+
+		const size_t reserved = max(MAP_RESERVE_LENGTH, detail::round_up(need * 4, MAP_COMMIT_LENGTH));
+		char* const base = detail::map_reserve(reserved);
+		size_t committed = 0;
+
+		if (old) {
+			const size_t old_reserved = old->reserved;
+			const size_t old_committed = old->committed;
+
+		#ifdef MREMAP_FIXED
+			// Move the committed pages over the start of the new
+			// reservation and drop the rest of the old one.
+			[[maybe_unused]] void* const r = mremap(old, old_committed, old_committed, MREMAP_MAYMOVE | MREMAP_FIXED, base);
+			BR_ASSERT(r == base);
+
+			munmap((char*)old + old_committed, old_reserved - old_committed);
+			committed = old_committed;
+		#else
+			detail::map_commit(base, 0, old_committed);
+			br::memcpy(old, base, old_committed);
+
+			munmap(old, old_reserved);
+			committed = old_committed;
+		#endif
+		}
+
+		detail::map_commit(base, committed, need);
+
+		auto h = (map_header*)base;
+		h->reserved = reserved;
+		h->committed = need;
+
+	#if defined(BR_ALLOC_STATS)
+		h->size = size;
+		h->site = index;
+	#endif
+
+		return (T*)(base + detail::MAP_HEADER_LENGTH);
+	}
+
+	template <typename T>
+	inline void map_free(T* ptr) {
+		if (ptr == nullptr)
+			return;
+
+		auto h = detail::map_header_of(ptr);
+
+	#if defined(BR_ALLOC_STATS)
+		detail::alloc_untrack(h->site, h->size);
+	#endif
+
+		munmap(h, h->reserved);
+	}
+
+#else
+	template <typename T>
+	[[nodiscard]] inline T* map_alloc(size_t count, T* old_ptr = nullptr, alloc_site site = alloc_site::current()) {
+		return br::alloc<T>(count, old_ptr, site);
+	}
+
+	template <typename T>
+	inline void map_free(T* ptr) {
+		br::free(ptr);
+	}
+#endif
+
+
+	// Allocator policies for containers.
+	// A container holds a policy and asks it for storage with
+	// `allocate`, which grows `old_ptr` from `old_count` to `count`
+	// elements keeping its contents like `realloc`, and hands storage
+	// back with `deallocate`. `allocate` passes on the container
+	// caller's `alloc_site`.
+	//   heap_allocator:   `br::alloc` and `br::free`, switching to
+	//                     `map_alloc` and `map_free` for blocks of
+	//                     `MAP_THRESHOLD_LENGTH` bytes and up. The
+	//                     size decides which so counts must be exact.
+	//   arena_allocator:  Bumps through an arena and never frees so
+	//                     containers don't need destroying. The block
+	//                     at the top of the arena grows in place.
+	//   buffer_allocator: A caller provided buffer, e.g. on the
+	//                     stack, moving to the heap if it outgrows it.
+	//                     Each container needs a buffer of its own.
+	struct heap_allocator {};
+
+	struct arena_allocator {
+		arena* region = nullptr;
+	};
+
+	struct buffer_allocator {
+		void* buffer = nullptr;
+		size_t bytes = 0;
+	};
+
+
+	template <typename> struct is_allocator: false_type {};
+
+	template <> struct is_allocator<heap_allocator>: true_type {};
+	template <> struct is_allocator<arena_allocator>: true_type {};
+	template <> struct is_allocator<buffer_allocator>: true_type {};
+
+	template <typename A>
+	inline constexpr bool is_allocator_v = is_allocator<A>::value;
+
+
+	template <typename T>
+	[[nodiscard]] inline T* allocate(heap_allocator&, T* old_ptr, size_t old_count, size_t count, alloc_site site) {
+		const bool was_mapped = old_ptr and sizeof(T) * old_count >= MAP_THRESHOLD_LENGTH;
+		const bool mapped = sizeof(T) * count >= MAP_THRESHOLD_LENGTH;
+
+		if (was_mapped == mapped or old_ptr == nullptr)
+			return mapped ? map_alloc<T>(count, old_ptr, site) : br::alloc<T>(count, old_ptr, site);
+
+		// Crossing the threshold.
+		T* const ptr = mapped ? map_alloc<T>(count, nullptr, site) : br::alloc<T>(count, nullptr, site);
+		br::memcpy(old_ptr, ptr, sizeof(T) * min(old_count, count));
+
+		if (was_mapped)
+			map_free(old_ptr);
+
+		else
+			br::free(old_ptr);
+
+		return ptr;
+	}
+
+	template <typename T>
+	inline void deallocate(heap_allocator&, T* ptr, size_t count) {
+		if (sizeof(T) * count >= MAP_THRESHOLD_LENGTH)
+			map_free(ptr);
+
+		else
+			br::free(ptr);
+	}
+
+
+	template <typename T>
+	[[nodiscard]] inline T* allocate(arena_allocator& a, T* old_ptr, size_t old_count, size_t count, alloc_site site) {
+		arena& r = *a.region;
+
+		// Extend the most recent allocation if there's room.
+		if (old_ptr and (char*)(old_ptr + old_count) == r.head and (ptr_t)(old_ptr + count) <= (ptr_t)r.tail) {
+			r.head = (char*)(old_ptr + count);
+			return old_ptr;
+		}
+
+		T* ptr;
+		r = arena_alloc(r, count, ptr, alignof(T), site);
+
+		if (old_ptr)
+			br::memcpy(old_ptr, ptr, sizeof(T) * min(old_count, count));
+
+		return ptr;
+	}
+
+	// Only the most recent allocation can be given back.
+	template <typename T>
+	inline void deallocate(arena_allocator& a, T* ptr, size_t count) {
+		arena& r = *a.region;
+
+		if (ptr and (char*)(ptr + count) == r.head)
+			r.head = (char*)ptr;
+	}
+
+
+	template <typename T>
+	[[nodiscard]] inline T* allocate(buffer_allocator& a, T* old_ptr, size_t old_count, size_t count, alloc_site site) {
+		T* const buffer = (T*)a.buffer;
+
+		if (old_ptr != nullptr and old_ptr != buffer)
+			return br::alloc<T>(count, old_ptr, site);
+
+		if (sizeof(T) * count <= a.bytes and (ptr_t)buffer % alignof(T) == 0)
+			return buffer;
+
+		T* ptr = br::alloc<T>(count, nullptr, site);
+
+		if (old_ptr)
+			br::memcpy(old_ptr, ptr, sizeof(T) * min(old_count, count));
+
+		return ptr;
+	}
+
+	template <typename T>
+	inline void deallocate(buffer_allocator& a, T* ptr, size_t count) {
+		if (ptr != (T*)a.buffer)
+			br::free(ptr);
+	}
 
 }
 
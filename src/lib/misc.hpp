@@ -159,11 +159,72 @@ namespace br {
 		#endif
 	}
 
+	// 64 bit version. (undefined for zero)
+	constexpr u32_t countl_zero(u64_t x) {
+		#if defined(BR_COMPILER_CLANG) || defined(BR_COMPILER_GCC)
+			return __builtin_clzll(x);
+		#else
+			u32_t count = 0;
+
+			while (not (x & (1ull << 63u))) {
+				count++;
+				x <<= 1;
+			}
+
+			return count;
+		#endif
+	}
+
 	constexpr u32_t countl_one(u32_t x) {
 		return countl_zero(~x);
 	}
 
 
+	// Count trailing zeros. (undefined for zero)
+	constexpr u32_t countr_zero(u64_t x) {
+		#if defined(BR_COMPILER_CLANG) || defined(BR_COMPILER_GCC)
+			return __builtin_ctzll(x);
+		#else
+			u32_t count = 0;
+
+			while (not (x & 1u)) {
+				count++;
+				x >>= 1;
+			}
+
+			return count;
+		#endif
+	}
+
+
+	// Count set bits.
+	constexpr u32_t popcount(u64_t x) {
+		#if defined(BR_COMPILER_CLANG) || defined(BR_COMPILER_GCC)
+			return __builtin_popcountll(x);
+		#else
+			u32_t count = 0;
+
+			for (; x; x &= x - 1)
+				count++;
+
+			return count;
+		#endif
+	}
+
+
+	// Detect if we are being evaluated at compile time so that
+	// constexpr functions can dispatch to SIMD paths at runtime.
+	// If the compiler can't tell us, we assume we are always being
+	// constant evaluated and stick to the portable path.
+	constexpr bool is_constant_evaluated() {
+		#if defined(BR_COMPILER_CLANG) || defined(BR_COMPILER_GCC)
+			return __builtin_is_constant_evaluated();
+		#else
+			return true;
+		#endif
+	}
+
+
 	// Wrap two types.
 	template <typename T1, typename T2>
 	struct pair_t {
@@ -0,0 +1,247 @@
+#ifndef BR_POOL_H
+#define BR_POOL_H
+
+#include <cstddef>
+#include <lib/def.hpp>
+#include <lib/assert.hpp>
+#include <lib/misc.hpp>
+#include <lib/mem.hpp>
+
+// Fixed size object pools.
+// Objects are carved out of large slabs and freed objects are kept
+// on an intrusive free list, threaded through the objects themselves,
+// to be handed out again. Slabs are only returned to the heap when
+// the pool is destroyed.
+// The pool is shared between threads but each thread allocates and
+// frees through its own `pool_cache` which needs no synchronisation.
+// Caches refill from and drain to the pool in batches of
+// `POOL_CACHE_LENGTH` objects under a spinlock so the lock is taken
+// once per batch rather than once per object.
+// A cache must be drained before its thread exits or its objects are
+// lost until the pool is destroyed.
+
+namespace br {
+
+	struct pool_stats {
+		size_t allocs = 0;
+		size_t frees = 0;
+		size_t hits = 0;  // Allocations served from a thread's cache.
+
+		size_t refills = 0;  // Batches moved from the pool to a cache.
+		size_t drains = 0;  // Batches moved from a cache to the pool.
+		size_t slabs = 0;
+	};
+
+
+	namespace detail {
+		struct pool_node {
+			pool_node* next;
+		};
+
+		struct pool_slab {
+			pool_slab* prev;
+			size_t size;
+		};
+
+		// A free object must be able to hold the list link.
+		template <typename T>
+		constexpr size_t pool_stride() {
+			constexpr size_t align = max(alignof(T), alignof(pool_node));
+			return (max(sizeof(T), sizeof(pool_node)) + align - 1) & ~(align - 1);
+		}
+
+		inline void pool_merge(pool_stats& to, pool_stats& from) {
+			to.allocs += from.allocs;
+			to.frees += from.frees;
+			to.hits += from.hits;
+			to.refills += from.refills;
+			to.drains += from.drains;
+			to.slabs += from.slabs;
+
+			from = {};
+		}
+	}
+
+
+	template <typename T>
+	struct pool {
+		detail::pool_node* free = nullptr;
+		detail::pool_slab* slabs = nullptr;
+
+		char* head = nullptr;  // Unused space in the newest slab.
+		char* tail = nullptr;
+
+		size_t slab_length = POOL_SLAB_LENGTH;  // Bytes per slab.
+		u32_t lock = 0;
+
+		pool_stats stats;  // Includes caches as of their last drain.
+	};
+
+	// Owned by a single thread.
+	template <typename T>
+	struct pool_cache {
+		detail::pool_node* free = nullptr;
+		size_t count = 0;
+
+		pool_stats stats;
+	};
+
+
+	namespace detail {
+		// Move up to `POOL_CACHE_LENGTH` objects into the cache,
+		// taking them from the free list first and the newest slab
+		// after that. Called with the pool locked.
+		template <typename T>
+		inline void pool_refill(pool<T>& p, pool_cache<T>& c, alloc_site site) {
+			constexpr size_t stride = pool_stride<T>();
+
+			for (index_t i = 0; i != POOL_CACHE_LENGTH; ++i) {
+				pool_node* n = p.free;
+
+				if (n)
+					p.free = n->next;
+
+				else {
+					if ((size_t)(p.tail - p.head) < stride) {
+						auto s = (pool_slab*)br::alloc<char>(sizeof(pool_slab) + p.slab_length, nullptr, site);
+						s->prev = p.slabs;
+						s->size = p.slab_length;
+
+						p.slabs = s;
+						p.head = (char*)(s + 1);
+						p.tail = p.head + p.slab_length;
+						p.stats.slabs++;
+					}
+
+					n = (pool_node*)p.head;
+					p.head += stride;
+				}
+
+				n->next = c.free;
+				c.free = n;
+			}
+
+			c.count += POOL_CACHE_LENGTH;
+			c.stats.refills++;
+		}
+
+		// Return `n` objects from the cache to the pool.
+		template <typename T>
+		inline void pool_drain(pool<T>& p, pool_cache<T>& c, size_t n) {
+			if (n == 0)
+				return;
+
+			// Find the end of the batch before taking the lock.
+			pool_node* first = c.free;
+			pool_node* last = first;
+
+			for (index_t i = 1; i != n; ++i)
+				last = last->next;
+
+			c.free = last->next;
+			c.count -= n;
+			c.stats.drains++;
+
+			BR_SCOPE(spin_lock(p.lock), spin_unlock(p.lock)) {
+				last->next = p.free;
+				p.free = first;
+			}
+		}
+	}
+
+
+	// Make a pool whose slabs hold `slab_length` bytes of objects.
+	template <typename T>
+	[[nodiscard]] inline pool<T> make_pool(size_t slab_length = POOL_SLAB_LENGTH) {
+		BR_STATIC_ASSERT(alignof(T) <= alignof(std::max_align_t));
+		BR_ASSERT(slab_length >= detail::pool_stride<T>());
+
+		pool<T> p;
+		p.slab_length = slab_length;
+
+		return p;
+	}
+
+	// Release every slab, including objects still in use or cached.
+	template <typename T>
+	[[nodiscard]] inline pool<T> destroy_pool(pool<T> p) {
+		while (p.slabs) {
+			auto prev = p.slabs->prev;
+			br::free(p.slabs);
+			p.slabs = prev;
+		}
+
+		return {};
+	}
+
+
+	// Allocate an uninitialised object.
+	template <typename T>
+	[[nodiscard]] inline T* pool_alloc(pool<T>& p, pool_cache<T>& c, alloc_site site = alloc_site::current()) {
+		c.stats.allocs++;
+
+		if (c.free)
+			c.stats.hits++;
+
+		else {
+			BR_SCOPE(detail::spin_lock(p.lock), detail::spin_unlock(p.lock))
+				detail::pool_refill(p, c, site);
+		}
+
+		auto n = c.free;
+		c.free = n->next;
+		c.count--;
+
+		return (T*)n;
+	}
+
+	// Return an object to the cache. Half of the cache goes back to
+	// the pool once it holds two batches so a thread that only frees
+	// doesn't hoard memory.
+	template <typename T>
+	inline void pool_free(pool<T>& p, pool_cache<T>& c, T* ptr) {
+		if (ptr == nullptr)
+			return;
+
+		c.stats.frees++;
+
+		auto n = (detail::pool_node*)ptr;
+		n->next = c.free;
+		c.free = n;
+		c.count++;
+
+		if (c.count >= POOL_CACHE_LENGTH * 2)
+			detail::pool_drain(p, c, POOL_CACHE_LENGTH);
+	}
+
+	// Return every cached object to the pool and fold the cache's
+	// counters into the pool's.
+	template <typename T>
+	inline void drain_pool_cache(pool<T>& p, pool_cache<T>& c) {
+		detail::pool_drain(p, c, c.count);
+
+		BR_SCOPE(detail::spin_lock(p.lock), detail::spin_unlock(p.lock))
+			detail::pool_merge(p.stats, c.stats);
+	}
+
+
+	// Counters as of the last drain of each cache.
+	template <typename T>
+	inline pool_stats stats(pool<T>& p) {
+		pool_stats s;
+
+		BR_SCOPE(detail::spin_lock(p.lock), detail::spin_unlock(p.lock))
+			s = p.stats;
+
+		return s;
+	}
+
+	// Bytes allocated from the heap.
+	template <typename T>
+	inline size_t memory_footprint(pool<T>& p) {
+		return stats(p).slabs * (sizeof(detail::pool_slab) + p.slab_length);
+	}
+
+}
+
+#endif
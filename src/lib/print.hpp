@@ -14,6 +14,7 @@
 #include <lib/exit.hpp>
 #include <lib/str.hpp>
 #include <lib/vec.hpp>
+#include <lib/small_vec.hpp>
 
 namespace br {
 
@@ -194,8 +195,8 @@ namespace br {
 
 
 		// Print containers.
-		template <typename T>
-		inline void print(stream ss, vec<T> v) {
+		template <typename T, typename A>
+		inline void print(stream ss, vec<T, A> v) {
 			print_container(ss, v);
 		}
 
@@ -206,6 +207,12 @@ namespace br {
 		}
 
 
+		template <typename T, size_t N, typename A>
+		inline void print(stream ss, small_vec<T, N, A> v) {
+			print_container(ss, v);
+		}
+
+
 		// Formatted print implementation.
 		template <typename T>
 		inline str_view printfmt_impl(stream ss, str_view fmt, T first) {
@@ -0,0 +1,67 @@
+#ifndef BR_SIMD_H
+#define BR_SIMD_H
+
+#include <cstring>
+
+#include <lib/def.hpp>
+
+#if defined(BR_SIMD_SSE42) || defined(BR_SIMD_AVX2)
+	#include <immintrin.h>
+#endif
+
+// Helpers shared by the vectorised paths.
+// SIMD kernels are selected at compile time based on the
+// extensions enabled by `-march` (see `BR_SIMD_*` in def.hpp).
+// Every kernel has a portable SWAR fallback that works on
+// 64 bit words so we never depend on a particular target.
+
+namespace br {
+
+	// Unaligned load/store of a word. The compiler lowers these
+	// to a single mov.
+	template <typename T>
+	inline T load(const void* const ptr) {
+		T x;
+		std::memcpy(&x, ptr, sizeof(T));
+		return x;
+	}
+
+	template <typename T>
+	inline void store(void* const ptr, T x) {
+		std::memcpy(ptr, &x, sizeof(T));
+	}
+
+
+	// SWAR (SIMD within a register) helpers.
+	// These assume a little endian target so that the lowest
+	// set bit of a mask corresponds to the first byte in memory.
+	constexpr u64_t SWAR_ONES = 0x0101010101010101ull;
+	constexpr u64_t SWAR_LOW7 = 0x7F7F7F7F7F7F7F7Full;
+	constexpr u64_t SWAR_HIGH = 0x8080808080808080ull;
+
+	// Copy a byte to every lane of a word.
+	constexpr u64_t swar_broadcast(u8_t b) {
+		return SWAR_ONES * b;
+	}
+
+	// Set the high bit of every byte in `x` that is zero.
+	// Unlike the classic `(x - 1) & ~x` trick, this is exact
+	// for every lane and so can be used to compute positions.
+	constexpr u64_t swar_zero(u64_t x) {
+		return ~(((x & SWAR_LOW7) + SWAR_LOW7) | x | SWAR_LOW7);
+	}
+
+	// Set the high bit of every byte in `x` that is equal to `b`.
+	constexpr u64_t swar_eq(u64_t x, u8_t b) {
+		return swar_zero(x ^ swar_broadcast(b));
+	}
+
+	// Gather the lowest bit of every byte into the low 8 bits
+	// so that bit `i` corresponds to byte `i`.
+	constexpr u64_t swar_pack(u64_t x) {
+		return ((x & SWAR_ONES) * 0x0102040810204080ull) >> 56;
+	}
+
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef BR_SMALL_VEC_H
+#define BR_SMALL_VEC_H
+
+#include <lib/def.hpp>
+#include <lib/trait.hpp>
+#include <lib/assert.hpp>
+#include <lib/misc.hpp>
+#include <lib/mem.hpp>
+#include <lib/array.hpp>
+#include <lib/vec.hpp>
+
+// Vector with inline storage.
+// The first `N` elements live inside the vector itself so it needs
+// no allocation until it outgrows them. After that every element
+// moves to storage from its allocator policy and it grows like `vec`.
+// Vectors are passed around by value so the elements can't be
+// referenced with a pointer into the inline storage. Access goes
+// through `data` which picks the inline storage or the heap.
+
+// Like `BR_MAKE_VEC`.
+#if defined(BR_ALLOC_STATS)
+	#define BR_MAKE_SMALL_VEC(N, ...) br::make_small_vec<N>(br::alloc_site::current(), __VA_ARGS__)
+#else
+	#define BR_MAKE_SMALL_VEC(N, ...) br::make_small_vec<N>(__VA_ARGS__)
+#endif
+
+namespace br {
+
+	// The allocator policy is a base as in `vec`.
+	template <typename T, size_t N, typename A = heap_allocator>
+	struct small_vec: A {
+		using type = T;
+		using allocator_type = A;
+
+		array<T, N> local;
+		T* heap = nullptr;  // Set once spilled.
+		size_t capacity = N;
+		size_t used = 0;
+	};
+
+
+	// Size and capacity.
+	template <typename T, size_t N, typename A>
+	constexpr size_t length(small_vec<T, N, A> v) {
+		return v.used;
+	}
+
+	template <typename T, size_t N, typename A>
+	constexpr size_t capacity(small_vec<T, N, A> v) {
+		return v.capacity;
+	}
+
+	// Whether the elements have moved to the heap.
+	template <typename T, size_t N, typename A>
+	constexpr bool spilled(small_vec<T, N, A> v) {
+		return v.heap != nullptr;
+	}
+
+
+	// Access a specific index.
+	template <typename T, size_t N, typename A>
+	constexpr auto data(small_vec<T, N, A>& v, index_t i) {
+		return v.heap ? v.heap + i : data(v.local, i);
+	}
+
+	template <typename T, size_t N, typename A>
+	constexpr A& allocator(small_vec<T, N, A>& v) {
+		return v;
+	}
+
+
+	namespace detail {
+		// Move to the heap or grow the heap storage.
+		template <typename T, size_t N, typename A>
+		[[nodiscard]] inline small_vec<T, N, A> grow(small_vec<T, N, A> v, size_t new_cap, alloc_site site) {
+			if (v.heap)
+				v.heap = allocate(allocator(v), v.heap, v.capacity, new_cap, site);
+
+			else {
+				v.heap = allocate(allocator(v), (T*)nullptr, 0, new_cap, site);
+				br::memcpy(v.local.data, v.heap, sizeof(T) * v.used);
+			}
+
+			v.capacity = new_cap;
+			return v;
+		}
+
+		template <typename T, size_t N, typename A, typename... Ts>
+		[[nodiscard]] constexpr small_vec<T, N, A> emplace(small_vec<T, N, A> v, alloc_site site, Ts... args) {
+			if (v.used == v.capacity)
+				v = grow(v, max(VEC_MINIMUM_LENGTH, grow_cap(v.capacity)), site);
+
+			*data(v, v.used) = T { args... };
+			v.used++;
+
+			return v;
+		}
+	}
+
+
+	// In-place construct an element.
+	template <typename T, size_t N, typename A, typename... Ts>
+	[[nodiscard]] constexpr small_vec<T, N, A> emplace(small_vec<T, N, A> v, Ts... args) {
+		return detail::emplace(v, alloc_site::current(), args...);
+	}
+
+	// As above but recorded against `site`, see `BR_EMPLACE`.
+	template <typename T, size_t N, typename A, typename... Ts>
+	[[nodiscard]] constexpr small_vec<T, N, A> emplace(alloc_site site, small_vec<T, N, A> v, Ts... args) {
+		return detail::emplace(v, site, args...);
+	}
+
+
+	// Push back an element.
+	template <typename T, size_t N, typename A>
+	[[nodiscard]] constexpr small_vec<T, N, A> push(small_vec<T, N, A> v, T x, alloc_site site = alloc_site::current()) {
+		return detail::emplace(v, site, x);
+	}
+
+	template <typename T, size_t N, typename A>
+	[[nodiscard]] constexpr small_vec<T, N, A> pop(small_vec<T, N, A> v, size_t n = 1) {
+		BR_ASSERT(n > 0);
+		v.used -= n;
+		return v;
+	}
+
+
+	// Make room for N more elements, see `reserve` on `vec`.
+	template <typename T, size_t N, typename A>
+	[[nodiscard]] constexpr small_vec<T, N, A> reserve(small_vec<T, N, A> v, size_t n, alloc_site site = alloc_site::current()) {
+		if (v.used + n > v.capacity)
+			v = detail::grow(v, v.used + n, site);
+
+		return v;
+	}
+
+
+	// Make a vector with no elements.
+	template <typename T, size_t N>
+	[[nodiscard]] constexpr auto make_small_vec() {
+		return small_vec<T, N>{};
+	}
+
+	// Make a vector with no elements which spills into storage from `a`.
+	template <typename T, size_t N, typename A, typename = enable_if_t<is_allocator_v<A>>>
+	[[nodiscard]] constexpr auto make_small_vec(A a) {
+		small_vec<T, N, A> v;
+		allocator(v) = a;
+
+		return v;
+	}
+
+
+	// Make a vector with a number of elements, keeping room for `N`
+	// inline.
+	template <size_t N, typename... Ts>
+	[[nodiscard]] constexpr auto make_small_vec(Ts... args) {
+		return make_small_vec<N>(alloc_site::current(), args...);
+	}
+
+	// As above but recorded against `site`, see `BR_MAKE_SMALL_VEC`.
+	template <size_t N, typename... Ts>
+	[[nodiscard]] constexpr auto make_small_vec(alloc_site site, Ts... args) {
+		using T = first_t<Ts...>;
+		BR_STATIC_ASSERT((equivalence_v<T, Ts...>));
+
+		auto v = small_vec<T, N>{};
+		v = reserve(v, sizeof...(Ts), site);
+
+		// Push back elements.
+		([&] (auto x) { v = push(v, (T)x, site); } (args), ...);
+
+		return v;
+	}
+
+
+	// Destroy a vector and release its memory if it spilled.
+	template <typename T, size_t N, typename A>
+	[[nodiscard]] constexpr small_vec<T, N, A> destroy_small_vec(small_vec<T, N, A> v) {
+		if (v.heap)
+			deallocate(allocator(v), v.heap, v.capacity);
+
+		v.heap = nullptr;
+		v.capacity = N;
+		v.used = 0;
+		return v;
+	}
+
+}
+
+#endif
@@ -4,6 +4,10 @@
 #include <lib/def.hpp>
 #include <lib/assert.hpp>
 #include <lib/misc.hpp>
+#include <lib/trait.hpp>
+#include <lib/simd.hpp>
+#include <lib/pow5.hpp>
+#include <lib/vec.hpp>
 
 // String view library.
 // This library is value oriented and so
@@ -27,8 +31,13 @@ namespace br {
 	constexpr size_t length(str_view);
 	constexpr size_t length(const char*);
 	constexpr size_t utf_length(str_view);
+	constexpr size_t utf_length_prefix(str_view, size_t);
 	constexpr bool eq(str_view, str_view);
+	constexpr i32_t compare(str_view, str_view);
+	constexpr bool starts_with(str_view, str_view);
+	constexpr bool ends_with(str_view, str_view);
 	constexpr bool utf_validate(str_view);
+	constexpr bool utf_validate_dfa(str_view);
 	constexpr bool eof(str_view);
 	constexpr bool is_null(str_view);
 
@@ -39,14 +48,19 @@ namespace br {
 	constexpr char_t char_at(str_view, index_t);
 	constexpr byte_t byte_at(str_view, index_t);
 	constexpr str_view view_at(str_view, index_t);
+	constexpr str_view substr(str_view, index_t, size_t);
 
 	constexpr u8_t utf_char_length(const char* const);
 	constexpr char_t utf_char_decode(const char* const, size_t);
+	constexpr u8_t utf_char_encode(char_t, char* const);
 
 	[[nodiscard]] constexpr str_view iter_next_char(str_view, char_t&, index_t = 1);
 	[[nodiscard]] constexpr str_view iter_next_byte(str_view, byte_t&, index_t = 1);
 	[[nodiscard]] constexpr str_view iter_next_view(str_view, str_view&, index_t = 1);
 
+	constexpr size_t ascii_length(str_view);
+	[[nodiscard]] constexpr str_view next_ascii_run(str_view, str_view&);
+
 	[[nodiscard]] constexpr str_view iter_prev_char(str_view, char_t&, index_t = 1);
 	[[nodiscard]] constexpr str_view iter_prev_byte(str_view, byte_t&, index_t = 1);
 	[[nodiscard]] constexpr str_view iter_prev_view(str_view, str_view&, index_t = 1);
@@ -72,6 +86,23 @@ namespace br {
 	[[nodiscard]] constexpr str_view grow_byte(str_view, index_t = 1);
 	[[nodiscard]] constexpr str_view shrink_byte(str_view, index_t = 1);
 
+	struct byte_set;
+
+	constexpr str_view find(str_view, str_view);
+	constexpr str_view find_byte(str_view, byte_t);
+	constexpr str_view find_any(str_view, const byte_set&);
+	constexpr str_view find_any(str_view, str_view);
+	constexpr str_view rfind(str_view, str_view);
+	constexpr str_view rfind_byte(str_view, byte_t);
+	[[nodiscard]] constexpr str_view iter_split(str_view, str_view, str_view&);
+
+	template <typename T> struct parse_result;
+
+	template <typename T> constexpr parse_result<T> parse_int(str_view);
+	template <typename T> constexpr parse_result<T> parse_hex(str_view);
+	template <typename T> constexpr parse_result<T> parse_bin(str_view);
+	inline parse_result<double> parse_float(str_view);
+
 	template <typename T> constexpr T to_int(str_view);
 
 
@@ -100,15 +131,81 @@ namespace br {
 		return { str, str + length };
 	}
 
+	namespace detail {
+		// Find the index of the first byte which differs between
+		// `a` and `b` or return `n` if they are equal.
+		constexpr size_t mismatch(const char* const a, const char* const b, size_t n) {
+			for (index_t i = 0; i != n; i++) {
+				if (a[i] != b[i])
+					return i;
+			}
+
+			return n;
+		}
+
+		// Compare a block at a time and use the lowest bit of the
+		// difference to locate the mismatch.
+		// We only ever load from inside [ptr, ptr + n) so we can
+		// never fault on a page boundary past the end of a view.
+		inline size_t mismatch_wide(const char* const a, const char* const b, size_t n) {
+			index_t i = 0;
+
+		#if defined(BR_SIMD_AVX2)
+			for (; n - i >= 32; i += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+				const __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+				const u32_t mask = ~(u32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+
+				if (mask)
+					return i + countr_zero(mask);
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			for (; n - i >= 16; i += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+				const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+				const u32_t mask = ~(u32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xFFFF;
+
+				if (mask)
+					return i + countr_zero(mask);
+			}
+		#endif
+
+			for (; n - i >= 8; i += 8) {
+				const u64_t x = load<u64_t>(a + i) ^ load<u64_t>(b + i);
+
+				if (x)
+					return i + countr_zero(x) / 8;
+			}
+
+			// Handle the tail with one overlapping word if we can.
+			// Everything before `i` is already known to be equal.
+			if (i != n and n >= 8) {
+				const u64_t x = load<u64_t>(a + n - 8) ^ load<u64_t>(b + n - 8);
+				return x ? (n - 8) + countr_zero(x) / 8 : n;
+			}
+
+			return i + mismatch(a + i, b + i, n - i);
+		}
+
+		constexpr size_t mismatch_dispatch(const char* const a, const char* const b, size_t n) {
+			if (not is_constant_evaluated())
+				return mismatch_wide(a, b, n);
+
+			return mismatch(a, b, n);
+		}
+	}
+
 	// Check if 2 str_views are equal.
 	// We perform a series of checks ranging from least
 	// expensive to most expensive.
 	// 1. Compare pointers
 	// 2. Compare lengths
-	// 3. Compare characters
+	// 3. Compare characters (a block at a time at runtime)
 	constexpr bool eq(str_view a, str_view b) {
-		// Compare the pointers.
-		if (a.begin == b.begin and a.end == b.end)
+		// Compare the pointers. Pointers into different literals
+		// can't be compared when constant evaluated.
+		if (not is_constant_evaluated() and a.begin == b.begin and a.end == b.end)
 			return true;
 
 		// Compare the length.
@@ -116,12 +213,36 @@ namespace br {
 			return false;
 
 		// Compare every character.
-		for (index_t i = 0; i < length(a); i++) {
-			if (*(a.begin + i) != *(b.begin + i))
-				return false;
-		}
+		return detail::mismatch_dispatch(a.begin, b.begin, length(a)) == length(a);
+	}
+
+	// Lexicographically compare 2 str_views by their bytes.
+	// Returns a negative number if `a` sorts before `b`, a positive
+	// number if it sorts after and zero if they are equal.
+	constexpr i32_t compare(str_view a, str_view b) {
+		const size_t n = min(length(a), length(b));
+		const size_t i = detail::mismatch_dispatch(a.begin, b.begin, n);
+
+		if (i != n)
+			return (i32_t)(u8_t)a.begin[i] - (i32_t)(u8_t)b.begin[i];
+
+		return (length(a) > length(b)) - (length(a) < length(b));
+	}
+
+	// Check if `sv` begins with `prefix`.
+	constexpr bool starts_with(str_view sv, str_view prefix) {
+		if (length(prefix) > length(sv))
+			return false;
+
+		return detail::mismatch_dispatch(sv.begin, prefix.begin, length(prefix)) == length(prefix);
+	}
+
+	// Check if `sv` ends with `suffix`.
+	constexpr bool ends_with(str_view sv, str_view suffix) {
+		if (length(suffix) > length(sv))
+			return false;
 
-		return true;
+		return detail::mismatch_dispatch(sv.end - length(suffix), suffix.begin, length(suffix)) == length(suffix);
 	}
 
 
@@ -229,16 +350,111 @@ namespace br {
 		return loop(ptr, 1);
 	}
 
+	namespace detail {
+		// Every byte except a continuation byte (10xxxxxx) starts
+		// a codepoint so counting codepoints in valid UTF-8 is the
+		// same as counting the bytes which are not continuations.
+		constexpr size_t utf_count_leads(const char* ptr, const char* const end) {
+			size_t count = 0;
+
+			for (; ptr != end; ++ptr)
+				count += (*ptr & 0b1100'0000) != 0b1000'0000;
+
+			return count;
+		}
+
+		// Portable fallback: 8 bytes at a time.
+		// A byte is a lead byte if bit 7 is clear or bit 6 is set.
+		inline size_t utf_count_leads_swar(const char* ptr, const char* const end) {
+			size_t count = 0;
+
+			for (; end - ptr >= 8; ptr += 8) {
+				const u64_t x = load<u64_t>(ptr);
+				count += popcount(((~x >> 7) | (x >> 6)) & SWAR_ONES);
+			}
+
+			return count + utf_count_leads(ptr, end);
+		}
+
+	#if defined(BR_SIMD_AVX2)
+		// Continuation bytes are the only bytes below -64 when
+		// interpreted as signed so a single compare finds the leads.
+		// Counts are accumulated per lane and summed with `psadbw`
+		// before the 8 bit lanes can overflow.
+		inline size_t utf_count_leads_avx2(const char* ptr, const char* const end) {
+			const __m256i threshold = _mm256_set1_epi8(-65);
+			const __m256i zero = _mm256_setzero_si256();
+
+			size_t count = 0;
+
+			while (end - ptr >= 32) {
+				const size_t n = min<size_t>((end - ptr) / 32, 255);
+				__m256i acc = zero;
+
+				for (index_t i = 0; i != n; ++i, ptr += 32) {
+					const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+					acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(x, threshold));
+				}
+
+				const __m256i sums = _mm256_sad_epu8(acc, zero);
+
+				count +=
+					(u64_t)_mm256_extract_epi64(sums, 0) + (u64_t)_mm256_extract_epi64(sums, 1) +
+					(u64_t)_mm256_extract_epi64(sums, 2) + (u64_t)_mm256_extract_epi64(sums, 3);
+			}
+
+			return count + utf_count_leads_swar(ptr, end);
+		}
+
+	#elif defined(BR_SIMD_SSE42)
+		inline size_t utf_count_leads_sse42(const char* ptr, const char* const end) {
+			const __m128i threshold = _mm_set1_epi8(-65);
+			const __m128i zero = _mm_setzero_si128();
+
+			size_t count = 0;
+
+			while (end - ptr >= 16) {
+				const size_t n = min<size_t>((end - ptr) / 16, 255);
+				__m128i acc = zero;
+
+				for (index_t i = 0; i != n; ++i, ptr += 16) {
+					const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+					acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(x, threshold));
+				}
+
+				const __m128i sums = _mm_sad_epu8(acc, zero);
+				count += (u64_t)_mm_extract_epi64(sums, 0) + (u64_t)_mm_extract_epi64(sums, 1);
+			}
+
+			return count + utf_count_leads_swar(ptr, end);
+		}
+	#endif
+	}
+
+
 	// Calculate the character size of a UTF-8 encoded string.
-	// We iterate character by character until we reach the end
-	// pointer.
+	// We count the bytes which begin a codepoint using the widest
+	// kernel available. This assumes the string is valid UTF-8.
 	constexpr size_t utf_length(str_view sv) {
-		size_t length = 0;
+		if (not is_constant_evaluated()) {
+			#if defined(BR_SIMD_AVX2)
+				return detail::utf_count_leads_avx2(sv.begin, sv.end);
+			#elif defined(BR_SIMD_SSE42)
+				return detail::utf_count_leads_sse42(sv.begin, sv.end);
+			#else
+				return detail::utf_count_leads_swar(sv.begin, sv.end);
+			#endif
+		}
 
-		for (; not eof(sv); sv = next_char(sv))
-			length++;
+		return detail::utf_count_leads(sv.begin, sv.end);
+	}
 
-		return length;
+	// Calculate the number of codepoints in the first `n` bytes
+	// of a string. This can be used to turn a byte offset into
+	// a column number.
+	constexpr size_t utf_length_prefix(str_view sv, size_t n) {
+		BR_ASSERT(n <= length(sv));
+		return utf_length(make_sv(sv.begin, n));
 	}
 
 	// Validate UTF-8 string.
@@ -267,8 +483,10 @@ namespace br {
 	#define BR_UTF_VALID    0
 	#define BR_UTF_INVALID  1
 
-	// Validate a UTF-8 encoded string.
-	constexpr bool utf_validate(str_view sv) {
+	// Validate a UTF-8 encoded string one byte at a time.
+	// This is the reference implementation and is used when
+	// constant evaluated.
+	constexpr bool utf_validate_dfa(str_view sv) {
 		char_t state = BR_UTF_VALID;
 
 		for (; not eof(sv); sv = next_byte(sv)) {
@@ -283,6 +501,756 @@ namespace br {
 	}
 
 
+	namespace detail {
+		// Portable fallback: skip ASCII 8 bytes at a time while
+		// we are between codepoints and run the DFA on the rest.
+		inline bool utf_validate_swar(str_view sv) {
+			const char* ptr = sv.begin;
+			char_t state = BR_UTF_VALID;
+
+			while (ptr != sv.end) {
+				if (state == BR_UTF_VALID) {
+					while (sv.end - ptr >= 8 and not (load<u64_t>(ptr) & SWAR_HIGH))
+						ptr += 8;
+
+					if (ptr == sv.end)
+						break;
+				}
+
+				char_t type = INTERNAL_UTF_TABLE__[(u8_t)*ptr++];
+				state = INTERNAL_UTF_TABLE__[256 + state + type];
+			}
+
+			return state == BR_UTF_VALID;
+		}
+
+
+		// Vectorised validation using the lookup algorithm from
+		// "Validating UTF-8 In Less Than One Instruction Per Byte"
+		// (Keiser & Lemire, https://arxiv.org/abs/2010.03090).
+		// Each byte is classified together with the byte before it
+		// using three 16 entry tables and the results are AND'd so
+		// that any surviving bit marks an error.
+		constexpr u8_t UTF_TOO_SHORT  = 1 << 0; // 11______ 0_______ or 11______ 11______
+		constexpr u8_t UTF_TOO_LONG   = 1 << 1; // 0_______ 10______
+		constexpr u8_t UTF_OVERLONG_3 = 1 << 2; // 11100000 100_____
+		constexpr u8_t UTF_TOO_LARGE  = 1 << 3; // 11110100 1001____ and above
+		constexpr u8_t UTF_SURROGATE  = 1 << 4; // 11101101 101_____
+		constexpr u8_t UTF_OVERLONG_2 = 1 << 5; // 1100000_ 10______
+		constexpr u8_t UTF_TOO_LARGE_1000 = 1 << 6; // 11110101 1000____ and above
+		constexpr u8_t UTF_OVERLONG_4 = 1 << 6; // 11110000 1000____
+		constexpr u8_t UTF_TWO_CONTS  = 1 << 7; // 10______ 10______
+
+		// These errors only depend on the high nibble of the first byte.
+		constexpr u8_t UTF_CARRY = UTF_TOO_SHORT | UTF_TOO_LONG | UTF_TWO_CONTS;
+
+		// Indexed by the high nibble of the previous byte.
+		constexpr u8_t INTERNAL_UTF_BYTE_1_HIGH__[] = {
+			UTF_TOO_LONG, UTF_TOO_LONG, UTF_TOO_LONG, UTF_TOO_LONG,
+			UTF_TOO_LONG, UTF_TOO_LONG, UTF_TOO_LONG, UTF_TOO_LONG,
+			UTF_TWO_CONTS, UTF_TWO_CONTS, UTF_TWO_CONTS, UTF_TWO_CONTS,
+			UTF_TOO_SHORT | UTF_OVERLONG_2,
+			UTF_TOO_SHORT,
+			UTF_TOO_SHORT | UTF_OVERLONG_3 | UTF_SURROGATE,
+			UTF_TOO_SHORT | UTF_TOO_LARGE | UTF_TOO_LARGE_1000 | UTF_OVERLONG_4,
+		};
+
+		// Indexed by the low nibble of the previous byte.
+		constexpr u8_t INTERNAL_UTF_BYTE_1_LOW__[] = {
+			UTF_CARRY | UTF_OVERLONG_3 | UTF_OVERLONG_2 | UTF_OVERLONG_4,
+			UTF_CARRY | UTF_OVERLONG_2,
+			UTF_CARRY,
+			UTF_CARRY,
+			UTF_CARRY | UTF_TOO_LARGE,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000 | UTF_SURROGATE,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+			UTF_CARRY | UTF_TOO_LARGE | UTF_TOO_LARGE_1000,
+		};
+
+		// Indexed by the high nibble of the current byte.
+		constexpr u8_t INTERNAL_UTF_BYTE_2_HIGH__[] = {
+			UTF_TOO_SHORT, UTF_TOO_SHORT, UTF_TOO_SHORT, UTF_TOO_SHORT,
+			UTF_TOO_SHORT, UTF_TOO_SHORT, UTF_TOO_SHORT, UTF_TOO_SHORT,
+			UTF_TOO_LONG | UTF_OVERLONG_2 | UTF_TWO_CONTS | UTF_OVERLONG_3 | UTF_TOO_LARGE_1000 | UTF_OVERLONG_4,
+			UTF_TOO_LONG | UTF_OVERLONG_2 | UTF_TWO_CONTS | UTF_OVERLONG_3 | UTF_TOO_LARGE,
+			UTF_TOO_LONG | UTF_OVERLONG_2 | UTF_TWO_CONTS | UTF_SURROGATE  | UTF_TOO_LARGE,
+			UTF_TOO_LONG | UTF_OVERLONG_2 | UTF_TWO_CONTS | UTF_SURROGATE  | UTF_TOO_LARGE,
+			UTF_TOO_SHORT, UTF_TOO_SHORT, UTF_TOO_SHORT, UTF_TOO_SHORT,
+		};
+
+		// Lead bytes at the very end of a block that still expect
+		// continuation bytes. Every lane but the last three is
+		// allowed to hold anything.
+		constexpr u8_t INTERNAL_UTF_INCOMPLETE__[] = {
+			255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+			255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+			0b11110000 - 1, 0b11100000 - 1, 0b11000000 - 1,
+		};
+
+	#if defined(BR_SIMD_AVX2)
+		struct utf_validator_avx2 {
+			__m256i error      = _mm256_setzero_si256();
+			__m256i prev       = _mm256_setzero_si256();
+			__m256i incomplete = _mm256_setzero_si256();
+		};
+
+		inline __m256i utf_table_avx2(const u8_t* const table) {
+			return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)table));
+		}
+
+		inline void utf_check_avx2(utf_validator_avx2& v, __m256i input) {
+			const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+			// Shift the previous block into the current one so that
+			// each lane can see the 1, 2 and 3 bytes before it.
+			const __m256i carried = _mm256_permute2x128_si256(v.prev, input, 0x21);
+			const __m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+			const __m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+			const __m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+
+			const __m256i byte_1_high = _mm256_shuffle_epi8(
+				utf_table_avx2(INTERNAL_UTF_BYTE_1_HIGH__),
+				_mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+
+			const __m256i byte_1_low = _mm256_shuffle_epi8(
+				utf_table_avx2(INTERNAL_UTF_BYTE_1_LOW__),
+				_mm256_and_si256(prev1, nibble));
+
+			const __m256i byte_2_high = _mm256_shuffle_epi8(
+				utf_table_avx2(INTERNAL_UTF_BYTE_2_HIGH__),
+				_mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+
+			const __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+			// Third and fourth bytes of a codepoint must be continuations.
+			// Only 111_____ and 1111____ survive the saturating subtraction
+			// with their high bit set.
+			const __m256i is_third  = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xE0 - 0x80)));
+			const __m256i is_fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xF0 - 0x80)));
+			const __m256i must_23   = _mm256_and_si256(_mm256_or_si256(is_third, is_fourth), _mm256_set1_epi8(char(0x80)));
+
+			v.error = _mm256_or_si256(v.error, _mm256_xor_si256(must_23, special));
+			v.incomplete = _mm256_subs_epu8(input, _mm256_loadu_si256((const __m256i*)INTERNAL_UTF_INCOMPLETE__));
+			v.prev = input;
+		}
+
+		// Validate 64 bytes per step.
+		inline void utf_step_avx2(utf_validator_avx2& v, const char* const ptr) {
+			const __m256i a = _mm256_loadu_si256((const __m256i*)ptr);
+			const __m256i b = _mm256_loadu_si256((const __m256i*)(ptr + 32));
+
+			// ASCII fast path: nothing to check other than the
+			// previous block not ending in the middle of a codepoint.
+			if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+				v.error = _mm256_or_si256(v.error, v.incomplete);
+				v.incomplete = _mm256_setzero_si256();
+				v.prev = b;
+				return;
+			}
+
+			utf_check_avx2(v, a);
+			utf_check_avx2(v, b);
+		}
+
+		inline bool utf_validate_avx2(str_view sv) {
+			utf_validator_avx2 v;
+			const char* ptr = sv.begin;
+
+			for (; sv.end - ptr >= 64; ptr += 64)
+				utf_step_avx2(v, ptr);
+
+			// Pad the tail with zeroes (ASCII) so we never read past the end.
+			if (ptr != sv.end) {
+				alignas(32) char buf[64] = {};
+				std::memcpy(buf, ptr, sv.end - ptr);
+				utf_step_avx2(v, buf);
+			}
+
+			const __m256i error = _mm256_or_si256(v.error, v.incomplete);
+			return _mm256_testz_si256(error, error);
+		}
+
+	#elif defined(BR_SIMD_SSE42)
+		struct utf_validator_sse42 {
+			__m128i error      = _mm_setzero_si128();
+			__m128i prev       = _mm_setzero_si128();
+			__m128i incomplete = _mm_setzero_si128();
+		};
+
+		inline void utf_check_sse42(utf_validator_sse42& v, __m128i input) {
+			const __m128i nibble = _mm_set1_epi8(0x0F);
+
+			const __m128i prev1 = _mm_alignr_epi8(input, v.prev, 15);
+			const __m128i prev2 = _mm_alignr_epi8(input, v.prev, 14);
+			const __m128i prev3 = _mm_alignr_epi8(input, v.prev, 13);
+
+			const __m128i byte_1_high = _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i*)INTERNAL_UTF_BYTE_1_HIGH__),
+				_mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+
+			const __m128i byte_1_low = _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i*)INTERNAL_UTF_BYTE_1_LOW__),
+				_mm_and_si128(prev1, nibble));
+
+			const __m128i byte_2_high = _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i*)INTERNAL_UTF_BYTE_2_HIGH__),
+				_mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+
+			const __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+			const __m128i is_third  = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xE0 - 0x80)));
+			const __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xF0 - 0x80)));
+			const __m128i must_23   = _mm_and_si128(_mm_or_si128(is_third, is_fourth), _mm_set1_epi8(char(0x80)));
+
+			v.error = _mm_or_si128(v.error, _mm_xor_si128(must_23, special));
+			v.incomplete = _mm_subs_epu8(input, _mm_loadu_si128((const __m128i*)(INTERNAL_UTF_INCOMPLETE__ + 16)));
+			v.prev = input;
+		}
+
+		// Validate 64 bytes per step.
+		inline void utf_step_sse42(utf_validator_sse42& v, const char* const ptr) {
+			const __m128i a = _mm_loadu_si128((const __m128i*)ptr);
+			const __m128i b = _mm_loadu_si128((const __m128i*)(ptr + 16));
+			const __m128i c = _mm_loadu_si128((const __m128i*)(ptr + 32));
+			const __m128i d = _mm_loadu_si128((const __m128i*)(ptr + 48));
+
+			if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0) {
+				v.error = _mm_or_si128(v.error, v.incomplete);
+				v.incomplete = _mm_setzero_si128();
+				v.prev = d;
+				return;
+			}
+
+			utf_check_sse42(v, a);
+			utf_check_sse42(v, b);
+			utf_check_sse42(v, c);
+			utf_check_sse42(v, d);
+		}
+
+		inline bool utf_validate_sse42(str_view sv) {
+			utf_validator_sse42 v;
+			const char* ptr = sv.begin;
+
+			for (; sv.end - ptr >= 64; ptr += 64)
+				utf_step_sse42(v, ptr);
+
+			if (ptr != sv.end) {
+				alignas(16) char buf[64] = {};
+				std::memcpy(buf, ptr, sv.end - ptr);
+				utf_step_sse42(v, buf);
+			}
+
+			const __m128i error = _mm_or_si128(v.error, v.incomplete);
+			return _mm_testz_si128(error, error);
+		}
+	#endif
+	}
+
+
+	// Validate a UTF-8 encoded string.
+	// At runtime we dispatch to the widest kernel available
+	// and fall back to the DFA when constant evaluated.
+	constexpr bool utf_validate(str_view sv) {
+		if (not is_constant_evaluated()) {
+			#if defined(BR_SIMD_AVX2)
+				return detail::utf_validate_avx2(sv);
+			#elif defined(BR_SIMD_SSE42)
+				return detail::utf_validate_sse42(sv);
+			#else
+				return detail::utf_validate_swar(sv);
+			#endif
+		}
+
+		return utf_validate_dfa(sv);
+	}
+
+
+	// Encode a codepoint as UTF-8 and return the number of bytes written.
+	// `out` must have room for at least 4 bytes.
+	constexpr u8_t utf_char_encode(char_t c, char* const out) {
+		if (c < 0x80) {
+			out[0] = c;
+			return 1;
+		}
+
+		if (c < 0x800) {
+			out[0] = 0b1100'0000 | (c >> 6);
+			out[1] = 0b1000'0000 | (c & 0b0011'1111);
+			return 2;
+		}
+
+		if (c < 0x10000) {
+			out[0] = 0b1110'0000 | (c >> 12);
+			out[1] = 0b1000'0000 | ((c >> 6) & 0b0011'1111);
+			out[2] = 0b1000'0000 | (c & 0b0011'1111);
+			return 3;
+		}
+
+		out[0] = 0b1111'0000 | (c >> 18);
+		out[1] = 0b1000'0000 | ((c >> 12) & 0b0011'1111);
+		out[2] = 0b1000'0000 | ((c >> 6) & 0b0011'1111);
+		out[3] = 0b1000'0000 | (c & 0b0011'1111);
+		return 4;
+	}
+
+
+	// Bulk conversion between UTF-8 and codepoints.
+	// Runs of ASCII are widened/narrowed 16 at a time. Everything
+	// else is converted 8 codepoints at a time with byte shuffles
+	// picked by the lengths of each group of 4 sequences, the way
+	// simdutf does. Decoding 4 byte sequences and the tail of the
+	// input go through the table decoder above.
+	namespace detail {
+		// Widen 16 bytes to codepoints if they are all ASCII.
+		inline bool utf_widen_ascii(const char* const ptr, char_t* const out) {
+		#if defined(BR_SIMD_AVX2)
+			const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+			if (_mm_movemask_epi8(x))
+				return false;
+
+			_mm256_storeu_si256((__m256i*)out,       _mm256_cvtepu8_epi32(x));
+			_mm256_storeu_si256((__m256i*)(out + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(x, 8)));
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+			if (_mm_movemask_epi8(x))
+				return false;
+
+			_mm_storeu_si128((__m128i*)out,        _mm_cvtepu8_epi32(x));
+			_mm_storeu_si128((__m128i*)(out + 4),  _mm_cvtepu8_epi32(_mm_srli_si128(x, 4)));
+			_mm_storeu_si128((__m128i*)(out + 8),  _mm_cvtepu8_epi32(_mm_srli_si128(x, 8)));
+			_mm_storeu_si128((__m128i*)(out + 12), _mm_cvtepu8_epi32(_mm_srli_si128(x, 12)));
+
+		#else
+			if ((load<u64_t>(ptr) | load<u64_t>(ptr + 8)) & SWAR_HIGH)
+				return false;
+
+			for (index_t i = 0; i != 16; ++i)
+				out[i] = ptr[i];
+		#endif
+
+			return true;
+		}
+
+		// Narrow 16 codepoints to bytes if they are all ASCII.
+		inline bool utf_narrow_ascii(const char_t* const ptr, char* const out) {
+		#if defined(BR_SIMD_AVX2)
+			const __m256i a = _mm256_loadu_si256((const __m256i*)ptr);
+			const __m256i b = _mm256_loadu_si256((const __m256i*)(ptr + 8));
+
+			// Any bits above the low 7 mean this isn't ASCII.
+			const __m256i high = _mm256_or_si256(a, b);
+
+			if (not _mm256_testz_si256(high, _mm256_set1_epi32(~0x7F)))
+				return false;
+
+			// Pack 32 -> 16 -> 8 bits. `packus` works within 128 bit lanes
+			// so we need to fix up the order of the 64 bit quarters in between.
+			const __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0b11'01'10'00);
+			const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+			_mm_storeu_si128((__m128i*)out, bytes);
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i a = _mm_loadu_si128((const __m128i*)ptr);
+			const __m128i b = _mm_loadu_si128((const __m128i*)(ptr + 4));
+			const __m128i c = _mm_loadu_si128((const __m128i*)(ptr + 8));
+			const __m128i d = _mm_loadu_si128((const __m128i*)(ptr + 12));
+
+			const __m128i high = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+
+			if (not _mm_testz_si128(high, _mm_set1_epi32(~0x7F)))
+				return false;
+
+			const __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_packus_epi32(c, d));
+			_mm_storeu_si128((__m128i*)out, bytes);
+
+		#else
+			char_t high = 0;
+
+			for (index_t i = 0; i != 16; ++i)
+				high |= ptr[i];
+
+			if (high & ~0x7Fu)
+				return false;
+
+			for (index_t i = 0; i != 16; ++i)
+				out[i] = ptr[i];
+		#endif
+
+			return true;
+		}
+
+
+		// Gathers 4 sequences of 1 to 3 bytes from a 16 byte block into
+		// the 32 bit lanes of a vector, last byte first, and masks off
+		// the length bits so the payload can be shifted together.
+		struct utf_decode_step {
+			u8_t shuffle[16];
+			u8_t mask[16];
+			u8_t length;  // Bytes consumed.
+		};
+
+		// Scatters the bytes of 4 encoded codepoints, held in lanes as
+		// 4 bytes in order, to the front of a 16 byte block.
+		struct utf_encode_step {
+			u8_t shuffle[16];
+			u8_t length;  // Bytes produced.
+		};
+
+		// Indexed by the 4 sequence lengths (minus one) in base 3.
+		struct utf_decode_steps {
+			utf_decode_step steps[81];
+			u8_t index[1 << 12];  // Mask of lead bytes in the first 12 bytes to step.
+		};
+
+		// Indexed by the 4 sequence lengths (minus one) in base 4.
+		struct utf_encode_steps {
+			utf_encode_step steps[256];
+			u8_t spread[16];  // Moves bit `i` to bit `i * 2`.
+		};
+
+		constexpr utf_decode_steps make_utf_decode_steps() {
+			utf_decode_steps t {};
+
+			for (index_t i = 0; i != 81; ++i) {
+				auto& step = t.steps[i];
+				u8_t offset = 0;
+
+				for (index_t j = 0; j != 16; ++j)
+					step.shuffle[j] = 0x80;
+
+				for (index_t lane = 0, rest = i; lane != 4; ++lane, rest /= 3) {
+					const index_t len = rest % 3 + 1;
+					constexpr u8_t lead[] = { 0x7F, 0x1F, 0x0F };
+
+					for (index_t k = 0; k != len; ++k) {
+						const index_t to = lane * 4 + (len - 1 - k);
+
+						step.shuffle[to] = offset + k;
+						step.mask[to] = k == 0 ? lead[len - 1] : 0x3F;
+					}
+
+					offset += len;
+				}
+
+				step.length = offset;
+			}
+
+			// The length of each sequence is the distance to the next lead
+			// byte. A sequence starting at 9 or before ends within 12 bytes.
+			for (index_t m = 0; m != (1 << 12); ++m) {
+				index_t pos = 0;
+				index_t i = 0;
+
+				for (index_t lane = 0, scale = 1; lane != 4; ++lane, scale *= 3) {
+					const index_t len = (m >> (pos + 1)) & 1 ? 1 : (m >> (pos + 2)) & 1 ? 2 : 3;
+
+					i += (len - 1) * scale;
+					pos += len;
+				}
+
+				t.index[m] = i;
+			}
+
+			return t;
+		}
+
+		constexpr utf_encode_steps make_utf_encode_steps() {
+			utf_encode_steps t {};
+
+			for (index_t i = 0; i != 256; ++i) {
+				auto& step = t.steps[i];
+				u8_t offset = 0;
+
+				for (index_t j = 0; j != 16; ++j)
+					step.shuffle[j] = 0x80;
+
+				for (index_t lane = 0; lane != 4; ++lane) {
+					const index_t len = ((i >> (lane * 2)) & 3) + 1;
+
+					for (index_t k = 0; k != len; ++k)
+						step.shuffle[offset + k] = lane * 4 + (4 - len) + k;
+
+					offset += len;
+				}
+
+				step.length = offset;
+			}
+
+			for (index_t m = 0; m != 16; ++m)
+				for (index_t bit = 0; bit != 4; ++bit)
+					t.spread[m] |= ((m >> bit) & 1) << (bit * 2);
+
+			return t;
+		}
+
+		constexpr utf_decode_steps INTERNAL_UTF_DECODE_STEPS__ = make_utf_decode_steps();
+		constexpr utf_encode_steps INTERNAL_UTF_ENCODE_STEPS__ = make_utf_encode_steps();
+
+
+		// Decode 4 codepoints of up to 3 bytes from the 16 bytes at `ptr`
+		// where `lead` is the mask of lead bytes. Returns the number of
+		// bytes consumed.
+		inline size_t utf_decode_step(const char* const ptr, u32_t lead, char_t* const out) {
+		#if defined(BR_SIMD_SSE42)
+			const auto& step = INTERNAL_UTF_DECODE_STEPS__.steps[INTERNAL_UTF_DECODE_STEPS__.index[lead & 0xFFF]];
+
+			const __m128i bytes = _mm_and_si128(
+				_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)ptr), _mm_loadu_si128((const __m128i*)step.shuffle)),
+				_mm_loadu_si128((const __m128i*)step.mask));
+
+			// Each byte holds 6 bits of payload (or less for a lead).
+			const __m128i cps = _mm_or_si128(
+				_mm_and_si128(bytes, _mm_set1_epi32(0xFF)),
+				_mm_or_si128(
+					_mm_srli_epi32(_mm_and_si128(bytes, _mm_set1_epi32(0xFF00)), 2),
+					_mm_srli_epi32(_mm_and_si128(bytes, _mm_set1_epi32(0xFF0000)), 4)));
+
+			_mm_storeu_si128((__m128i*)out, cps);
+			return step.length;
+
+		#else
+			return 0;
+		#endif
+		}
+
+		// Decode the next 8 codepoints if none of them take 4 bytes and
+		// return the number of bytes consumed or 0 if they can't be.
+		// Needs 32 readable bytes. The lead bytes for both halves are
+		// found up front so only the table lookups depend on where the
+		// first half ended.
+		inline size_t utf_decode_short(const char* const ptr, char_t* const out) {
+		#if defined(BR_SIMD_SSE42)
+			const __m128i a = _mm_loadu_si128((const __m128i*)ptr);
+			const __m128i b = _mm_loadu_si128((const __m128i*)(ptr + 16));
+
+			// Continuation bytes are 0x80..0xBF which is below -64 as a
+			// signed byte and 4 byte leads are 0xF0..0xF4, above -17.
+			const __m128i cont_lo = _mm_set1_epi8(-64);
+			const __m128i four_lo = _mm_set1_epi8(-17);
+
+			const u32_t cont = _mm_movemask_epi8(_mm_cmplt_epi8(a, cont_lo)) | (_mm_movemask_epi8(_mm_cmplt_epi8(b, cont_lo)) << 16);
+			const u32_t four = _mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(a, four_lo), a)) | (_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(b, four_lo), b)) << 16);
+
+			// 8 sequences of up to 3 bytes end within 24 bytes.
+			if (four & 0xFF'FFFF)
+				return 0;
+
+			const size_t first = utf_decode_step(ptr, ~cont, out);
+			return first + utf_decode_step(ptr + first, ~cont >> first, out + 4);
+
+		#else
+			return 0;
+		#endif
+		}
+
+
+		// Every codepoint is encoded as 4 bytes and the shuffle drops
+		// the leading ones that a shorter sequence doesn't need. Each
+		// byte is a continuation byte unless it's the lead of that
+		// length, which only needs a few more bits set.
+		// `one`, `two` and `three` are the lanes below U+80, U+800 and
+		// U+10000.
+	#if defined(BR_SIMD_AVX2)
+		inline __m256i utf_encode_lanes(__m256i cps, __m256i one, __m256i two, __m256i three) {
+			const __m256i low = _mm256_set1_epi32(0x3F);
+			const __m256i cont = _mm256_set1_epi32(0x80);
+
+			const __m256i b0 = _mm256_or_si256(_mm256_srli_epi32(cps, 18), _mm256_set1_epi32(0xF0));
+			const __m256i b1 = _mm256_or_si256(
+				_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(cps, 12), low), cont),
+				_mm256_and_si256(_mm256_andnot_si256(two, three), _mm256_set1_epi32(0x60)));
+			const __m256i b2 = _mm256_or_si256(
+				_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(cps, 6), low), cont),
+				_mm256_and_si256(_mm256_andnot_si256(one, two), _mm256_set1_epi32(0x40)));
+			const __m256i b3 = _mm256_blendv_epi8(_mm256_or_si256(_mm256_and_si256(cps, low), cont), cps, one);
+
+			return _mm256_or_si256(
+				_mm256_or_si256(b0, _mm256_slli_epi32(b1, 8)),
+				_mm256_or_si256(_mm256_slli_epi32(b2, 16), _mm256_slli_epi32(b3, 24)));
+		}
+
+	#elif defined(BR_SIMD_SSE42)
+		inline __m128i utf_encode_lanes(__m128i cps, __m128i one, __m128i two, __m128i three) {
+			const __m128i low = _mm_set1_epi32(0x3F);
+			const __m128i cont = _mm_set1_epi32(0x80);
+
+			const __m128i b0 = _mm_or_si128(_mm_srli_epi32(cps, 18), _mm_set1_epi32(0xF0));
+			const __m128i b1 = _mm_or_si128(
+				_mm_or_si128(_mm_and_si128(_mm_srli_epi32(cps, 12), low), cont),
+				_mm_and_si128(_mm_andnot_si128(two, three), _mm_set1_epi32(0x60)));
+			const __m128i b2 = _mm_or_si128(
+				_mm_or_si128(_mm_and_si128(_mm_srli_epi32(cps, 6), low), cont),
+				_mm_and_si128(_mm_andnot_si128(one, two), _mm_set1_epi32(0x40)));
+			const __m128i b3 = _mm_blendv_epi8(_mm_or_si128(_mm_and_si128(cps, low), cont), cps, one);
+
+			return _mm_or_si128(
+				_mm_or_si128(b0, _mm_slli_epi32(b1, 8)),
+				_mm_or_si128(_mm_slli_epi32(b2, 16), _mm_slli_epi32(b3, 24)));
+		}
+	#endif
+
+		// Step for 4 lanes from masks of the lanes below U+80, U+800 and
+		// U+10000. A lane's length is 4 minus the masks it's in.
+		inline const utf_encode_step& utf_encode_step_for(u32_t one, u32_t two, u32_t three) {
+			const auto& t = INTERNAL_UTF_ENCODE_STEPS__;
+			return t.steps[0xFF - t.spread[one] - t.spread[two] - t.spread[three]];
+		}
+
+		// Encode the next 8 codepoints and return the number of bytes
+		// written. Writes up to 32 bytes.
+		inline size_t utf_encode_short(const char_t* const ptr, char* const out) {
+		#if defined(BR_SIMD_AVX2)
+			const __m256i cps = _mm256_loadu_si256((const __m256i*)ptr);
+
+			const __m256i one = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x80), cps);
+			const __m256i two = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x800), cps);
+			const __m256i three = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x10000), cps);
+
+			const u32_t ones = _mm256_movemask_ps(_mm256_castsi256_ps(one));
+			const u32_t twos = _mm256_movemask_ps(_mm256_castsi256_ps(two));
+			const u32_t threes = _mm256_movemask_ps(_mm256_castsi256_ps(three));
+
+			// `vpshufb` doesn't cross 128 bit halves so each gets its
+			// own step.
+			const auto& lo = utf_encode_step_for(ones & 0xF, twos & 0xF, threes & 0xF);
+			const auto& hi = utf_encode_step_for(ones >> 4, twos >> 4, threes >> 4);
+
+			const __m256i shuffle = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)lo.shuffle)),
+				_mm_loadu_si128((const __m128i*)hi.shuffle), 1);
+
+			const __m256i bytes = _mm256_shuffle_epi8(utf_encode_lanes(cps, one, two, three), shuffle);
+
+			_mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(bytes));
+			_mm_storeu_si128((__m128i*)(out + lo.length), _mm256_extracti128_si256(bytes, 1));
+
+			return lo.length + hi.length;
+
+		#elif defined(BR_SIMD_SSE42)
+			size_t written = 0;
+
+			for (index_t half = 0; half != 2; ++half) {
+				const __m128i cps = _mm_loadu_si128((const __m128i*)(ptr + half * 4));
+
+				const __m128i one = _mm_cmplt_epi32(cps, _mm_set1_epi32(0x80));
+				const __m128i two = _mm_cmplt_epi32(cps, _mm_set1_epi32(0x800));
+				const __m128i three = _mm_cmplt_epi32(cps, _mm_set1_epi32(0x10000));
+
+				const auto& step = utf_encode_step_for(
+					_mm_movemask_ps(_mm_castsi128_ps(one)),
+					_mm_movemask_ps(_mm_castsi128_ps(two)),
+					_mm_movemask_ps(_mm_castsi128_ps(three)));
+
+				const __m128i bytes = _mm_shuffle_epi8(utf_encode_lanes(cps, one, two, three), _mm_loadu_si128((const __m128i*)step.shuffle));
+				_mm_storeu_si128((__m128i*)(out + written), bytes);
+
+				written += step.length;
+			}
+
+			return written;
+
+		#else
+			size_t written = 0;
+
+			for (index_t i = 0; i != 8; ++i)
+				written += utf_char_encode(ptr[i], out + written);
+
+			return written;
+		#endif
+		}
+	}
+
+
+	// Decode a valid UTF-8 string into a buffer of codepoints and
+	// return the number of codepoints written.
+	// `out` must have room for at least `length(sv)` codepoints.
+	inline size_t utf_decode(str_view sv, char_t* const out) {
+		auto ptr = sv.begin;
+		auto dest = out;
+
+		while (ptr != sv.end) {
+			for (; sv.end - ptr >= 16 and detail::utf_widen_ascii(ptr, dest); ptr += 16)
+				dest += 16;
+
+			// Decode codepoints 4 or one at a time until we have
+			// consumed at least another 16 bytes and then try ASCII
+			// again.
+			const auto stop = sv.begin + min<size_t>(length(sv), (ptr - sv.begin) + 16);
+
+			while (ptr < stop) {
+				if (sv.end - ptr >= 32) {
+					if (const auto len = detail::utf_decode_short(ptr, dest)) {
+						ptr += len;
+						dest += 8;
+						continue;
+					}
+				}
+
+				// Past a 4 byte sequence (or to the end) one at a time.
+				for (index_t i = 0; i != 8 and ptr != sv.end; ++i) {
+					const auto len = utf_char_length(ptr);
+					*dest++ = utf_char_decode(ptr, len);
+					ptr += len;
+				}
+			}
+		}
+
+		// Make sure we don't walk forwards beyond the end pointer.
+		BR_ASSERT(ptr <= sv.end);
+
+		return dest - out;
+	}
+
+	// Decode and append to a vector.
+	[[nodiscard]] inline vec<char_t> utf_decode(str_view sv, vec<char_t> v) {
+		v = reserve(v, length(sv));
+		v.used += utf_decode(sv, v.data + v.used);
+		return v;
+	}
+
+
+	// Encode a buffer of codepoints as UTF-8 and return the number
+	// of bytes written.
+	// `out` must have room for at least `n * 4` bytes.
+	inline size_t utf_encode(const char_t* const ptr, size_t n, char* const out) {
+		auto dest = out;
+		index_t i = 0;
+
+		while (i != n) {
+			for (; n - i >= 16 and detail::utf_narrow_ascii(ptr + i, dest); i += 16)
+				dest += 16;
+
+			const auto stop = min<size_t>(n, i + 16);
+
+			for (; i < stop and n - i >= 8; i += 8)
+				dest += detail::utf_encode_short(ptr + i, dest);
+
+			for (; i < stop; ++i)
+				dest += utf_char_encode(ptr[i], dest);
+		}
+
+		return dest - out;
+	}
+
+	// Encode and append to a vector.
+	[[nodiscard]] inline vec<char> utf_encode(vec<char_t> in, vec<char> v) {
+		v = reserve(v, length(in) * 4);
+		v.used += utf_encode(in.data, length(in), v.data + v.used);
+		return v;
+	}
+
+
 	// Character iteration.
 	constexpr str_view next_char(str_view sv, index_t n) {
 		if (n == 0)
@@ -358,10 +1326,106 @@ namespace br {
 	}
 
 
-	// Mutable iteration. (decode and skip forward together)
-	constexpr str_view iter_next_char(str_view sv, char_t& c, index_t i) {
-		// Skip i-1 chars. If i is zero, we add 1 so we dont overflow.
-		sv = next_char(sv, i - (i != 0));
+	// ASCII runs.
+	namespace detail {
+		// Find the length of the leading run of ASCII bytes.
+		constexpr size_t ascii_prefix(const char* const begin, const char* const end) {
+			auto ptr = begin;
+
+			while (ptr != end and not (*ptr & 0b1000'0000))
+				++ptr;
+
+			return ptr - begin;
+		}
+
+		// Portable fallback: check 8 bytes at a time and use the
+		// position of the first high bit to find the end of the run.
+		inline size_t ascii_prefix_swar(const char* const begin, const char* const end) {
+			auto ptr = begin;
+
+			for (; end - ptr >= 8; ptr += 8) {
+				const u64_t high = load<u64_t>(ptr) & SWAR_HIGH;
+
+				if (high)
+					return (ptr - begin) + countr_zero(high) / 8;
+			}
+
+			return (ptr - begin) + ascii_prefix(ptr, end);
+		}
+
+	#if defined(BR_SIMD_AVX2)
+		inline size_t ascii_prefix_avx2(const char* const begin, const char* const end) {
+			auto ptr = begin;
+
+			for (; end - ptr >= 32; ptr += 32) {
+				const u32_t mask = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)ptr));
+
+				if (mask)
+					return (ptr - begin) + countr_zero(mask);
+			}
+
+			return (ptr - begin) + ascii_prefix_swar(ptr, end);
+		}
+
+	#elif defined(BR_SIMD_SSE42)
+		inline size_t ascii_prefix_sse42(const char* const begin, const char* const end) {
+			auto ptr = begin;
+
+			for (; end - ptr >= 16; ptr += 16) {
+				const u32_t mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ptr));
+
+				if (mask)
+					return (ptr - begin) + countr_zero(mask);
+			}
+
+			return (ptr - begin) + ascii_prefix_swar(ptr, end);
+		}
+	#endif
+	}
+
+	// Length in bytes (and codepoints) of the leading ASCII run.
+	constexpr size_t ascii_length(str_view sv) {
+		if (not is_constant_evaluated()) {
+			#if defined(BR_SIMD_AVX2)
+				return detail::ascii_prefix_avx2(sv.begin, sv.end);
+			#elif defined(BR_SIMD_SSE42)
+				return detail::ascii_prefix_sse42(sv.begin, sv.end);
+			#else
+				return detail::ascii_prefix_swar(sv.begin, sv.end);
+			#endif
+		}
+
+		return detail::ascii_prefix(sv.begin, sv.end);
+	}
+
+	// Split off the leading run of ASCII bytes in bulk.
+	// Every byte in `run` is also a codepoint so a lexer can
+	// handle it without decoding and only fall back to
+	// `iter_next_char` for the multibyte parts:
+	//
+	//   while (not eof(sv)) {
+	//     sv = next_ascii_run(sv, run);
+	//     ...
+	//     if (not eof(sv))
+	//       sv = iter_next_char(sv, c);
+	//   }
+	constexpr str_view next_ascii_run(str_view sv, str_view& run) {
+		const auto len = ascii_length(sv);
+		run = { sv.begin, sv.begin + len };
+		return { sv.begin + len, sv.end };
+	}
+
+
+	// Mutable iteration. (decode and skip forward together)
+	constexpr str_view iter_next_char(str_view sv, char_t& c, index_t i) {
+		// Skip i-1 chars. If i is zero, we add 1 so we dont overflow.
+		sv = next_char(sv, i - (i != 0));
+
+		// ASCII doesn't need decoding.
+		if (not (*sv.begin & 0b1000'0000)) {
+			c = *sv.begin++;
+			return sv;
+		}
 
 		// Get current codepoint length and then decode.
 		const auto len = utf_char_length(sv.begin);
@@ -435,6 +1499,9 @@ namespace br {
 
 	// Return a UTF-8 codepoint decoded to a u32 integer.
 	constexpr char_t as_char(str_view sv) {
+		if (not (*sv.begin & 0b1000'0000))
+			return *sv.begin;
+
 		return utf_char_decode(sv.begin, utf_char_length(sv.begin));
 	}
 
@@ -468,16 +1535,905 @@ namespace br {
 		return as_view(sv);
 	}
 
+	// Return `n` codepoints starting at codepoint `i`.
+	constexpr str_view substr(str_view sv, index_t i, size_t n) {
+		sv = next_char(sv, i);
+		return { sv.begin, next_char(sv, n).begin };
+	}
+
+
+	// Codepoint index.
+	// Random access by codepoint is O(n) on UTF-8 so for large
+	// documents we can record the byte offset of every `stride`th
+	// codepoint up front. Lookups then jump to the nearest sample
+	// and walk at most `stride - 1` codepoints.
+	// The index costs `8 / stride` bytes per codepoint so a larger
+	// stride trades lookup speed for memory.
+	struct utf_index {
+		str_view sv;
+		size_t stride = UTF_INDEX_STRIDE;
+		size_t length = 0;     // Number of codepoints in `sv`.
+		vec<index_t> offsets;  // Byte offset of codepoint `i * stride`.
+	};
+
+
+	namespace detail {
+		// Bitmask of the bytes which start a codepoint in a block of 64.
+		inline u64_t utf_lead_mask(const char* const ptr) {
+		#if defined(BR_SIMD_AVX2)
+			const __m256i threshold = _mm256_set1_epi8(-65);
+
+			const u32_t lo = _mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_loadu_si256((const __m256i*)ptr), threshold));
+			const u32_t hi = _mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_loadu_si256((const __m256i*)(ptr + 32)), threshold));
+
+			return (u64_t)lo | ((u64_t)hi << 32);
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i threshold = _mm_set1_epi8(-65);
+			u64_t mask = 0;
+
+			for (index_t i = 0; i != 4; ++i) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)(ptr + i * 16));
+				mask |= (u64_t)(u16_t)_mm_movemask_epi8(_mm_cmpgt_epi8(x, threshold)) << (i * 16);
+			}
+
+			return mask;
+
+		#else
+			u64_t mask = 0;
+
+			for (index_t i = 0; i != 8; ++i) {
+				const u64_t x = load<u64_t>(ptr + i * 8);
+				mask |= swar_pack((~x >> 7) | (x >> 6)) << (i * 8);
+			}
+
+			return mask;
+		#endif
+		}
+	}
+
+
+	// Build an index over `sv` in a single pass.
+	// We look at 64 bytes at a time and only locate individual
+	// codepoints in blocks that contain a sample.
+	[[nodiscard]] inline utf_index make_utf_index(str_view sv, size_t stride = UTF_INDEX_STRIDE) {
+		BR_ASSERT(stride > 0);
+
+		utf_index idx { sv, stride, 0, make_vec<index_t>() };
+
+		size_t count = 0; // Codepoints seen so far.
+		size_t next = 0;  // Next codepoint to sample.
+
+		auto ptr = sv.begin;
+
+		for (; sv.end - ptr >= 64; ptr += 64) {
+			u64_t mask = detail::utf_lead_mask(ptr);
+			const size_t n = popcount(mask);
+
+			// Drop lead bytes from the mask until the lowest one
+			// is the codepoint we want to sample.
+			for (size_t seen = count; next < count + n; next += stride) {
+				for (; seen != next; ++seen)
+					mask &= mask - 1;
+
+				idx.offsets = push(idx.offsets, (index_t)((ptr - sv.begin) + countr_zero(mask)));
+			}
+
+			count += n;
+		}
+
+		for (; ptr != sv.end; ++ptr) {
+			if ((*ptr & 0b1100'0000) == 0b1000'0000)
+				continue;
+
+			if (count == next) {
+				idx.offsets = push(idx.offsets, (index_t)(ptr - sv.begin));
+				next += stride;
+			}
+
+			count++;
+		}
+
+		idx.length = count;
+
+		return idx;
+	}
+
+	[[nodiscard]] inline utf_index destroy_utf_index(utf_index idx) {
+		idx.offsets = destroy_vec(idx.offsets);
+		idx.length = 0;
+		return idx;
+	}
+
+
+	// Indexed versions of the functions above.
+	inline size_t utf_length(const utf_index& idx) {
+		return idx.length;
+	}
+
+	inline str_view next_char(const utf_index& idx, index_t i) {
+		BR_ASSERT(i <= idx.length);
+
+		// Past the last sample we might have fewer than `stride`
+		// codepoints left so just go to the end.
+		if (i == idx.length)
+			return { idx.sv.end, idx.sv.end };
+
+		const auto sample = at(idx.offsets, i / idx.stride);
+		return next_char(next_byte(idx.sv, sample), i % idx.stride);
+	}
+
+	inline char_t char_at(const utf_index& idx, index_t i) {
+		return as_char(next_char(idx, i));
+	}
+
+	inline str_view view_at(const utf_index& idx, index_t i) {
+		return as_view(next_char(idx, i));
+	}
+
+	inline str_view substr(const utf_index& idx, index_t i, size_t n) {
+		return { next_char(idx, i).begin, next_char(idx, i + n).begin };
+	}
+
+
+	// Searching.
+	// All of these return a view starting at the match and
+	// extending to the end of `sv`. If there is no match, an
+	// empty view at the end of `sv` is returned instead so that
+	// `eof(find(...))` can be used to test for failure.
+
+	// A set of bytes to search for with `find_any`.
+	// For sets of ASCII bytes we build two 16 entry tables so that
+	// membership can be tested for a whole vector with two shuffles:
+	// `lo` holds a bit for every high nibble that appears with a
+	// given low nibble and `INTERNAL_NIBBLE_BIT__` maps a high nibble
+	// to its bit.
+	struct byte_set {
+		u8_t lo[16] {};
+		u64_t bits[4] {}; // Bitmap of all 256 bytes for the scalar path.
+		bool ascii = true;
+	};
+
+	namespace detail {
+		constexpr u8_t INTERNAL_NIBBLE_BIT__[] = {
+			1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7,
+			0, 0, 0, 0, 0, 0, 0, 0,
+		};
+	}
+
+	constexpr byte_set make_byte_set(str_view set) {
+		byte_set bs;
+
+		for (auto ptr = set.begin; ptr != set.end; ++ptr) {
+			const u8_t b = *ptr;
+
+			bs.bits[b / 64] |= 1ull << (b % 64);
+			bs.lo[b & 0x0F] |= detail::INTERNAL_NIBBLE_BIT__[b >> 4];
+			bs.ascii = bs.ascii and b < 0x80;
+		}
+
+		return bs;
+	}
+
+	constexpr bool contains(const byte_set& bs, byte_t b) {
+		return bs.bits[b / 64] & (1ull << (b % 64));
+	}
+
+
+	namespace detail {
+		constexpr str_view not_found(str_view sv) {
+			return { sv.end, sv.end };
+		}
+
+		// Find the first occurrence of `b`.
+		inline const char* find_byte_wide(const char* ptr, const char* const end, byte_t b) {
+		#if defined(BR_SIMD_AVX2)
+			const __m256i needle = _mm256_set1_epi8(b);
+
+			for (; end - ptr >= 32; ptr += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+				const u32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, needle));
+
+				if (mask)
+					return ptr + countr_zero(mask);
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i needle = _mm_set1_epi8(b);
+
+			for (; end - ptr >= 16; ptr += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+				const u32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, needle));
+
+				if (mask)
+					return ptr + countr_zero(mask);
+			}
+		#endif
+
+			for (; end - ptr >= 8; ptr += 8) {
+				const u64_t mask = swar_eq(load<u64_t>(ptr), b);
+
+				if (mask)
+					return ptr + countr_zero(mask) / 8;
+			}
+
+			for (; ptr != end; ++ptr) {
+				if ((byte_t)*ptr == b)
+					return ptr;
+			}
+
+			return end;
+		}
+
+		// Find the last occurrence of `b`.
+		inline const char* rfind_byte_wide(const char* const begin, const char* end, byte_t b) {
+		#if defined(BR_SIMD_AVX2)
+			const __m256i needle = _mm256_set1_epi8(b);
+
+			for (; end - begin >= 32; end -= 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)(end - 32));
+				const u32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, needle));
+
+				if (mask)
+					return end - 1 - countl_zero(mask);
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i needle = _mm_set1_epi8(b);
+
+			for (; end - begin >= 16; end -= 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)(end - 16));
+				const u32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, needle)) << 16;
+
+				if (mask)
+					return end - 1 - countl_zero(mask);
+			}
+		#endif
+
+			for (; end - begin >= 8; end -= 8) {
+				const u64_t mask = swar_eq(load<u64_t>(end - 8), b);
+
+				if (mask)
+					return end - 1 - countl_zero(mask) / 8;
+			}
+
+			while (end != begin) {
+				if ((byte_t)*--end == b)
+					return end;
+			}
+
+			return nullptr;
+		}
+
+		// Find the first byte which is in `bs`.
+		inline const char* find_any_wide(const char* ptr, const char* const end, const byte_set& bs) {
+		#if defined(BR_SIMD_AVX2)
+			if (bs.ascii) {
+				const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)bs.lo));
+				const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)INTERNAL_NIBBLE_BIT__));
+				const __m256i nibble = _mm256_set1_epi8(0x0F);
+				const __m256i zero = _mm256_setzero_si256();
+
+				for (; end - ptr >= 32; ptr += 32) {
+					const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+
+					const __m256i matches = _mm256_and_si256(
+						_mm256_shuffle_epi8(lo, _mm256_and_si256(x, nibble)),
+						_mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+
+					const u32_t mask = ~(u32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(matches, zero));
+
+					if (mask)
+						return ptr + countr_zero(mask);
+				}
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			if (bs.ascii) {
+				const __m128i lo = _mm_loadu_si128((const __m128i*)bs.lo);
+				const __m128i hi = _mm_loadu_si128((const __m128i*)INTERNAL_NIBBLE_BIT__);
+				const __m128i nibble = _mm_set1_epi8(0x0F);
+				const __m128i zero = _mm_setzero_si128();
+
+				for (; end - ptr >= 16; ptr += 16) {
+					const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+					const __m128i matches = _mm_and_si128(
+						_mm_shuffle_epi8(lo, _mm_and_si128(x, nibble)),
+						_mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), nibble)));
+
+					const u32_t mask = ~(u32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(matches, zero)) & 0xFFFF;
+
+					if (mask)
+						return ptr + countr_zero(mask);
+				}
+			}
+		#endif
+
+			for (; ptr != end; ++ptr) {
+				if (contains(bs, *ptr))
+					return ptr;
+			}
+
+			return end;
+		}
+
+		// Substring search by filtering on the first and last byte
+		// of the needle (http://0x80.pl/articles/simd-strfind.html).
+		// Candidates are confirmed with `mismatch_wide`.
+		inline const char* find_wide(const char* ptr, const char* const end, str_view needle) {
+			const size_t m = length(needle);
+			const byte_t first = needle.begin[0];
+			const byte_t last = needle.begin[m - 1];
+
+		#if defined(BR_SIMD_AVX2)
+			const __m256i f = _mm256_set1_epi8(first);
+			const __m256i l = _mm256_set1_epi8(last);
+
+			for (; end - ptr >= (offset_t)(m - 1 + 32); ptr += 32) {
+				const __m256i a = _mm256_loadu_si256((const __m256i*)ptr);
+				const __m256i b = _mm256_loadu_si256((const __m256i*)(ptr + m - 1));
+
+				u32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, f), _mm256_cmpeq_epi8(b, l)));
+
+				for (; mask; mask &= mask - 1) {
+					const auto candidate = ptr + countr_zero(mask);
+
+					if (mismatch_wide(candidate + 1, needle.begin + 1, m - 2) == m - 2)
+						return candidate;
+				}
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i f = _mm_set1_epi8(first);
+			const __m128i l = _mm_set1_epi8(last);
+
+			for (; end - ptr >= (offset_t)(m - 1 + 16); ptr += 16) {
+				const __m128i a = _mm_loadu_si128((const __m128i*)ptr);
+				const __m128i b = _mm_loadu_si128((const __m128i*)(ptr + m - 1));
+
+				u32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, f), _mm_cmpeq_epi8(b, l)));
+
+				for (; mask; mask &= mask - 1) {
+					const auto candidate = ptr + countr_zero(mask);
+
+					if (mismatch_wide(candidate + 1, needle.begin + 1, m - 2) == m - 2)
+						return candidate;
+				}
+			}
+		#endif
+
+			// Finish off using the first byte to skip ahead.
+			for (; end - ptr >= (offset_t)m; ++ptr) {
+				ptr = find_byte_wide(ptr, end - m + 1, first);
+
+				if (ptr == end - m + 1)
+					break;
+
+				if ((byte_t)ptr[m - 1] == last and mismatch_wide(ptr, needle.begin, m) == m)
+					return ptr;
+			}
+
+			return end;
+		}
+	}
+
+
+	// Find the first occurrence of the byte `b`.
+	constexpr str_view find_byte(str_view sv, byte_t b) {
+		if (not is_constant_evaluated())
+			return { detail::find_byte_wide(sv.begin, sv.end, b), sv.end };
+
+		for (; not eof(sv); sv = next_byte(sv)) {
+			if (as_byte(sv) == b)
+				return sv;
+		}
+
+		return sv;
+	}
+
+	// Find the first byte which is a member of `set`.
+	constexpr str_view find_any(str_view sv, const byte_set& set) {
+		if (not is_constant_evaluated())
+			return { detail::find_any_wide(sv.begin, sv.end, set), sv.end };
+
+		for (; not eof(sv); sv = next_byte(sv)) {
+			if (contains(set, as_byte(sv)))
+				return sv;
+		}
+
+		return sv;
+	}
+
+	constexpr str_view find_any(str_view sv, str_view set) {
+		return find_any(sv, make_byte_set(set));
+	}
+
+	// Find the first occurrence of `needle`.
+	constexpr str_view find(str_view sv, str_view needle) {
+		if (eof(needle))
+			return sv;
+
+		if (length(needle) > length(sv))
+			return detail::not_found(sv);
+
+		if (length(needle) == 1)
+			return find_byte(sv, as_byte(needle));
+
+		if (not is_constant_evaluated())
+			return { detail::find_wide(sv.begin, sv.end, needle), sv.end };
+
+		for (; length(sv) >= length(needle); sv = next_byte(sv)) {
+			if (starts_with(sv, needle))
+				return sv;
+		}
+
+		return detail::not_found(sv);
+	}
+
+	// Find the last occurrence of the byte `b`.
+	constexpr str_view rfind_byte(str_view sv, byte_t b) {
+		if (not is_constant_evaluated()) {
+			const auto ptr = detail::rfind_byte_wide(sv.begin, sv.end, b);
+			return ptr ? str_view { ptr, sv.end } : detail::not_found(sv);
+		}
+
+		for (auto ptr = sv.end; ptr != sv.begin;) {
+			if ((byte_t)*--ptr == b)
+				return { ptr, sv.end };
+		}
+
+		return detail::not_found(sv);
+	}
+
+	// Find the last occurrence of `needle`.
+	// We search backwards for the last byte of the needle
+	// and then check the bytes before it.
+	constexpr str_view rfind(str_view sv, str_view needle) {
+		if (eof(needle))
+			return detail::not_found(sv);
+
+		const size_t m = length(needle);
+		const byte_t last = needle.begin[m - 1];
+
+		// Only consider positions where the whole needle fits.
+		auto window = make_sv(sv.begin + min(length(sv), m - 1), sv.end);
+
+		while (not eof(window)) {
+			const auto match = rfind_byte(window, last);
+
+			if (eof(match))
+				break;
+
+			if (starts_with(make_sv(match.begin - (m - 1), sv.end), needle))
+				return make_sv(match.begin - (m - 1), sv.end);
+
+			window = make_sv(window.begin, match.begin);
+		}
+
+		return detail::not_found(sv);
+	}
+
+
+	// Lazily split a view on `delim`.
+	// `piece` is set to the text before the next delimiter and the
+	// rest of the view after it is returned. Once the last piece has
+	// been produced, a null view is returned:
+	//
+	//   for (auto it = sv; not is_null(it);) {
+	//     it = iter_split(it, ","_sv, piece);
+	//     ...
+	//   }
+	//
+	// Like most split functions, "a,b," produces "a", "b" and "".
+	constexpr str_view iter_split(str_view sv, str_view delim, str_view& piece) {
+		BR_ASSERT(not eof(delim));
+
+		const auto match = find(sv, delim);
+
+		piece = { sv.begin, match.begin };
+
+		if (eof(match))
+			return { nullptr, nullptr };
+
+		return next_byte(match, length(delim));
+	}
+
 
 	// Conversion functions.
+	// Every parser consumes as much of the front of `sv` as forms a
+	// valid number and reports the rest so that callers can continue
+	// lexing from there. On failure, `ok` is false and nothing is
+	// consumed.
+	template <typename T>
+	struct parse_result {
+		T value {};
+		str_view rest;
+		bool ok = false;
+	};
+
+
+	namespace detail {
+		constexpr bool is_digit(char c) {
+			return c >= '0' and c <= '9';
+		}
+
+		// Value of a digit in any radix up to 36 or 255 if `c`
+		// isn't a digit.
+		constexpr u8_t digit_value(char c) {
+			if (c >= '0' and c <= '9') return c - '0';
+			if (c >= 'a' and c <= 'z') return c - 'a' + 10;
+			if (c >= 'A' and c <= 'Z') return c - 'A' + 10;
+			return 255;
+		}
+
+		// Check if a word is made up of 8 ASCII digits.
+		constexpr bool swar_is_digits(u64_t x) {
+			return (
+				(x & 0xF0F0F0F0F0F0F0F0ull) |
+				(((x + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)
+			) == 0x3333333333333333ull;
+		}
+
+		// Convert a word of 8 ASCII digits to its value by combining
+		// pairs of digits, then pairs of pairs and so on.
+		// The first byte in memory is the most significant digit.
+		constexpr u64_t swar_parse_digits(u64_t x) {
+			constexpr u64_t mask = 0x000000FF000000FFull;
+			constexpr u64_t mul1 = 100 + (1000000ull << 32);
+			constexpr u64_t mul2 = 1 + (10000ull << 32);
+
+			x -= 0x3030303030303030ull;
+			x = (x * 10) + (x >> 8);
+
+			return (((x & mask) * mul1) + (((x >> 16) & mask) * mul2)) >> 32;
+		}
+
+		// Check if a word is made up of 8 ASCII `0` or `1` bytes.
+		constexpr bool swar_is_bits(u64_t x) {
+			return (x & ~SWAR_ONES) == 0x3030303030303030ull;
+		}
+
+		// Convert a word of 8 ASCII `0`/`1` bytes to its value.
+		constexpr u64_t swar_parse_bits(u64_t x) {
+			return ((x & SWAR_ONES) * 0x8040201008040201ull) >> 56;
+		}
+
+		// Parse an optional sign and return a pointer past it.
+		constexpr const char* parse_sign(const char* ptr, const char* const end, bool& negative) {
+			negative = false;
+
+			if (ptr != end and (*ptr == '-' or *ptr == '+'))
+				negative = *ptr++ == '-';
+
+			return ptr;
+		}
+
+		// Check `acc` fits in `T` (with sign) and build the result.
+		template <typename T>
+		constexpr parse_result<T> make_int_result(str_view sv, const char* const ptr, u64_t acc, bool negative) {
+			const u64_t limit = (u64_t)limit_max<T>() + negative;
+
+			if (negative and is_unsigned_v<T>)
+				return { T {}, sv, false };
+
+			if (acc > limit)
+				return { T {}, sv, false };
+
+			return { negative ? (T)(0 - acc) : (T)acc, { ptr, sv.end }, true };
+		}
+
+		// Parse digits in a power of 2 radix.
+		template <typename T, u8_t Shift>
+		constexpr parse_result<T> parse_pow2(str_view sv) {
+			constexpr u8_t radix = 1u << Shift;
+
+			bool negative = false;
+			auto ptr = parse_sign(sv.begin, sv.end, negative);
+			const auto digits = ptr;
+
+			u64_t acc = 0;
+			bool overflow = false;
+
+			// Binary can be done 8 digits at a time.
+			if constexpr (Shift == 1) {
+				if (not is_constant_evaluated()) {
+					for (; sv.end - ptr >= 8 and not (acc >> 56) and swar_is_bits(load<u64_t>(ptr)); ptr += 8)
+						acc = (acc << 8) | swar_parse_bits(load<u64_t>(ptr));
+				}
+			}
+
+			for (; ptr != sv.end and digit_value(*ptr) < radix; ++ptr) {
+				overflow = overflow or (acc >> (64 - Shift));
+				acc = (acc << Shift) | digit_value(*ptr);
+			}
+
+			if (ptr == digits or overflow)
+				return { T {}, sv, false };
+
+			return make_int_result<T>(sv, ptr, acc, negative);
+		}
+	}
+
+
+	// Parse a decimal integer with an optional sign.
+	// Digits are consumed 8 at a time while the value can't overflow.
+	template <typename T = br::size_t>
+	constexpr parse_result<T> parse_int(str_view sv) {
+		bool negative = false;
+		auto ptr = detail::parse_sign(sv.begin, sv.end, negative);
+		const auto digits = ptr;
+
+		u64_t acc = 0;
+		bool overflow = false;
+
+		// `acc` is below 10^11 so `acc * 10^8 + 99999999` can't overflow.
+		if (not is_constant_evaluated()) {
+			for (; sv.end - ptr >= 8 and acc < 100000000000ull and detail::swar_is_digits(load<u64_t>(ptr)); ptr += 8)
+				acc = acc * 100000000ull + detail::swar_parse_digits(load<u64_t>(ptr));
+		}
+
+		for (; ptr != sv.end and detail::is_digit(*ptr); ++ptr) {
+			const u64_t d = *ptr - '0';
+			overflow = overflow or acc > (limit_max<u64_t>() - d) / 10;
+			acc = acc * 10 + d;
+		}
+
+		if (ptr == digits or overflow)
+			return { T {}, sv, false };
+
+		return detail::make_int_result<T>(sv, ptr, acc, negative);
+	}
+
+	// Parse hexadecimal/binary digits (without any `0x`/`0b` prefix).
+	template <typename T = br::size_t>
+	constexpr parse_result<T> parse_hex(str_view sv) {
+		return detail::parse_pow2<T, 4>(sv);
+	}
+
+	template <typename T = br::size_t>
+	constexpr parse_result<T> parse_bin(str_view sv) {
+		return detail::parse_pow2<T, 1>(sv);
+	}
+
+	// Parse an integer, returning zero if `sv` doesn't begin with one.
 	template <typename T = br::size_t> constexpr T to_int(str_view sv) {
-		T num {};
+		return parse_int<T>(sv).value;
+	}
+
 
-		for (auto ptr = sv.begin; ptr != sv.end; ++ptr) {
-			num = (num * 10) + (*ptr - '0');
+	namespace detail {
+		struct u128_t {
+			u64_t high;
+			u64_t low;
+		};
+
+		constexpr u128_t mul_full(u64_t a, u64_t b) {
+		#if defined(BR_COMPILER_CLANG) || defined(BR_COMPILER_GCC)
+			__extension__ using u128 = unsigned __int128;
+			const u128 r = (u128)a * b;
+			return { u64_t(r >> 64), u64_t(r) };
+		#else
+			const u64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+			const u64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+
+			const u64_t lo_lo = a_lo * b_lo;
+			const u64_t hi_lo = a_hi * b_lo;
+			const u64_t lo_hi = a_lo * b_hi;
+			const u64_t hi_hi = a_hi * b_hi;
+
+			const u64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+
+			return { (hi_lo >> 32) + (cross >> 32) + hi_hi, (cross << 32) | (lo_lo & 0xFFFFFFFF) };
+		#endif
 		}
 
-		return num;
+		inline double bits_to_double(u64_t bits) {
+			return load<double>(&bits);
+		}
+
+		// Eisel-Lemire: compute the closest double to `w * 10^q`
+		// using a truncated 128 bit product with 5^q.
+		// For `w` with at most 19 digits this is always correctly
+		// rounded (Mushtak & Lemire, "Fast Number Parsing Without
+		// Fallback") so we never need a slow path here.
+		inline double eisel_lemire(u64_t w, i64_t q) {
+			constexpr i32_t mantissa_bits = 52;
+			constexpr i32_t minimum_exponent = -1023;
+			constexpr i32_t infinite_power = 0x7FF;
+
+			if (q < POW5_SMALLEST)
+				return 0.0;
+
+			if (q > POW5_LARGEST)
+				return bits_to_double((u64_t)infinite_power << mantissa_bits);
+
+			const u32_t lz = countl_zero(w);
+			w <<= lz;
+
+			// We need 55 bits of precision. Only if the bits below
+			// that are all ones could the low word change the result.
+			const index_t i = 2 * (q - POW5_SMALLEST);
+			constexpr u64_t precision_mask = limit_max<u64_t>() >> (mantissa_bits + 3);
+
+			auto product = mul_full(w, INTERNAL_POW5_TABLE__[i]);
+
+			if ((product.high & precision_mask) == precision_mask) {
+				const auto second = mul_full(w, INTERNAL_POW5_TABLE__[i + 1]);
+				product.low += second.high;
+				product.high += second.high > product.low;
+			}
+
+			const i32_t upperbit = product.high >> 63;
+			const i32_t shift = upperbit + 64 - mantissa_bits - 3;
+
+			u64_t mantissa = product.high >> shift;
+
+			// floor(log2(10^q)) + 63
+			const i32_t power = (((152170 + 65536) * (i32_t)q) >> 16) + 63;
+			i32_t power2 = power + upperbit - lz - minimum_exponent;
+
+			// Subnormal.
+			if (power2 <= 0) {
+				if (-power2 + 1 >= 64)
+					return 0.0;
+
+				mantissa >>= -power2 + 1;
+				mantissa += mantissa & 1;
+				mantissa >>= 1;
+
+				power2 = mantissa < (1ull << mantissa_bits) ? 0 : 1;
+
+				return bits_to_double(mantissa | ((u64_t)power2 << mantissa_bits));
+			}
+
+			// Exactly halfway between two floats: round to even.
+			if (product.low <= 1 and q >= -4 and q <= 23 and (mantissa & 3) == 1) {
+				if ((mantissa << shift) == product.high)
+					mantissa &= ~1ull;
+			}
+
+			mantissa += mantissa & 1;
+			mantissa >>= 1;
+
+			if (mantissa >= (2ull << mantissa_bits)) {
+				mantissa = 1ull << mantissa_bits;
+				power2++;
+			}
+
+			mantissa &= ~(1ull << mantissa_bits);
+
+			if (power2 >= infinite_power)
+				return bits_to_double((u64_t)infinite_power << mantissa_bits);
+
+			return bits_to_double(mantissa | ((u64_t)power2 << mantissa_bits));
+		}
+
+		// Powers of 10 which are exactly representable as doubles.
+		constexpr double INTERNAL_EXACT_POW10__[] = {
+			1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+		};
+
+		// Fall back to the C library for numbers with more than 19
+		// significant digits.
+		inline double parse_float_slow(str_view sv) {
+			char buf[128];
+			char* str = length(sv) < sizeof(buf) ? buf : br::alloc<char>(length(sv) + 1);
+
+			std::memcpy(str, sv.begin, length(sv));
+			str[length(sv)] = '\0';
+
+			const double value = std::strtod(str, nullptr);
+
+			if (str != buf)
+				br::free(str);
+
+			return value;
+		}
+	}
+
+
+	// Parse a decimal floating point number of the form
+	// `[+-]digits[.digits][(e|E)[+-]digits]` and round it correctly.
+	// Small numbers are handled exactly with a single multiply or
+	// divide (Clinger's fast path) and everything else goes through
+	// Eisel-Lemire.
+	inline parse_result<double> parse_float(str_view sv) {
+		bool negative = false;
+		auto ptr = detail::parse_sign(sv.begin, sv.end, negative);
+
+		u64_t w = 0;           // Significant digits.
+		i64_t exponent = 0;    // Power of 10 to apply to `w`.
+		size_t significant = 0;
+		size_t digits = 0;
+		bool truncated = false;
+
+		// Accumulate up to 19 significant digits into `w`. Leading
+		// zeros don't count and digits past the 19th only move the
+		// exponent.
+		const auto consume = [&] (bool fraction) {
+			while (ptr != sv.end) {
+				if (w != 0 and significant + 8 <= 19 and sv.end - ptr >= 8 and detail::swar_is_digits(load<u64_t>(ptr))) {
+					w = w * 100000000ull + detail::swar_parse_digits(load<u64_t>(ptr));
+					significant += 8;
+					digits += 8;
+					exponent -= fraction * 8;
+					ptr += 8;
+					continue;
+				}
+
+				if (not detail::is_digit(*ptr))
+					break;
+
+				const u64_t d = *ptr++ - '0';
+				digits++;
+
+				if (significant < 19) {
+					w = w * 10 + d;
+					significant += w != 0;
+					exponent -= fraction;
+				}
+
+				else {
+					truncated = truncated or d != 0;
+					exponent += not fraction;
+				}
+			}
+		};
+
+		consume(false);
+
+		if (ptr != sv.end and *ptr == '.') {
+			++ptr;
+			consume(true);
+		}
+
+		if (digits == 0)
+			return { 0.0, sv, false };
+
+		// Only consume the exponent if it's well formed.
+		if (ptr != sv.end and (*ptr == 'e' or *ptr == 'E')) {
+			bool exp_negative;
+			auto exp_ptr = detail::parse_sign(ptr + 1, sv.end, exp_negative);
+
+			if (exp_ptr != sv.end and detail::is_digit(*exp_ptr)) {
+				i64_t exp = 0;
+
+				for (; exp_ptr != sv.end and detail::is_digit(*exp_ptr); ++exp_ptr)
+					exp = min<i64_t>(exp * 10 + (*exp_ptr - '0'), 1'000'000);
+
+				exponent += exp_negative ? -exp : exp;
+				ptr = exp_ptr;
+			}
+		}
+
+		const str_view rest = { ptr, sv.end };
+		double value;
+
+		if (truncated)
+			value = detail::parse_float_slow({ sv.begin, ptr });
+
+		else if (w == 0)
+			value = 0.0;
+
+		// Both `w` and `10^|exponent|` are exact so a single
+		// correctly rounded operation gives a correct result.
+		else if (exponent >= -22 and exponent <= 22 and w <= (1ull << 53)) {
+			value = (double)w;
+			value = exponent < 0 ?
+				value / detail::INTERNAL_EXACT_POW10__[-exponent] :
+				value * detail::INTERNAL_EXACT_POW10__[exponent];
+		}
+
+		else
+			value = detail::eisel_lemire(w, exponent);
+
+		// The slow path already handled the sign.
+		if (negative and not truncated)
+			value = -value;
+
+		return { value, rest, true };
 	}
 
 }
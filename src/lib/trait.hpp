@@ -170,6 +170,17 @@ namespace br {
 	using conditional_t = typename conditional<B, T, F>::type;
 
 
+	// enable_if
+	template <bool B, typename T = void>
+	struct enable_if {};
+
+	template <typename T>
+	struct enable_if<true, T> { using type = T; };
+
+	template <bool B, typename T = void>
+	using enable_if_t = typename enable_if<B, T>::type;
+
+
 	// conjunction (logical and)
 	template <typename...> struct conjunction: true_type { };
 
@@ -2,6 +2,10 @@
 #define BR_UNICODE_HPP
 
 #include <lib/def.hpp>
+#include <lib/misc.hpp>
+#include <lib/simd.hpp>
+#include <lib/str.hpp>
+#include <lib/vec.hpp>
 
 namespace br {
 	#include <lib/unicode_internal.hpp>
@@ -9,49 +13,1285 @@ namespace br {
 
 namespace br {
 
-	inline bool is_letter(char_t c) {
-		return is_lu(c) or is_ll(c) or is_lt(c) or is_lm(c) or is_lo(c);
+	// General category of a codepoint.
+	// Two table reads: the high bits of `c` select a block and the
+	// low bits index into it. Identical blocks are shared which keeps
+	// the tables small.
+	constexpr category_t category(char_t c) {
+		if (c > 0x10FFFF)
+			return CATEGORY_CN;
+
+		constexpr size_t shift = INTERNAL_CATEGORY_SHIFT__;
+		constexpr char_t mask = (1u << shift) - 1;
+
+		const size_t block = INTERNAL_CATEGORY_STAGE1__[c >> shift];
+		return INTERNAL_CATEGORY_STAGE2__[(block << shift) | (c & mask)];
+	}
+
+
+	// Sets of categories as bitmasks.
+	constexpr u32_t category_bit(category_t cat) {
+		return 1u << cat;
+	}
+
+	constexpr u32_t CATEGORY_MASK_OTHER =
+		category_bit(CATEGORY_CC) | category_bit(CATEGORY_CF) | category_bit(CATEGORY_CS) |
+		category_bit(CATEGORY_CO);
+
+	// Check if a codepoint belongs to any category in `mask`.
+	constexpr bool is_category(char_t c, u32_t mask) {
+		return (category_bit(category(c)) & mask) != 0;
+	}
+
+
+	// Property bits of a codepoint (see `PROPERTY_*`).
+	// ASCII is looked up in a small table of its own since it
+	// dominates most input.
+	constexpr property_t properties(char_t c) {
+		if (c < length(INTERNAL_PROPERTY_ASCII__))
+			return INTERNAL_PROPERTY_ASCII__[c];
+
+		if (c > 0x10FFFF)
+			return 0;
+
+		constexpr size_t shift = INTERNAL_PROPERTY_SHIFT__;
+		constexpr char_t mask = (1u << shift) - 1;
+
+		const size_t block = INTERNAL_PROPERTY_STAGE1__[c >> shift];
+		return INTERNAL_PROPERTY_STAGE2__[(block << shift) | (c & mask)];
+	}
+
+	// Check if a codepoint has any property in `mask`.
+	constexpr bool has_property(char_t c, property_t mask) {
+		return (properties(c) & mask) != 0;
+	}
+
+	constexpr property_t PROPERTY_SEPERATOR    = PROPERTY_SPACE | PROPERTY_LINE;
+	constexpr property_t PROPERTY_ALPHANUMERIC = PROPERTY_LETTER | PROPERTY_NUMBER;
+	constexpr property_t PROPERTY_VISIBLE      = PROPERTY_ALPHANUMERIC | PROPERTY_SYMBOL | PROPERTY_PUNCTUATION;
+	constexpr property_t PROPERTY_WHITESPACE   = PROPERTY_SPACE | PROPERTY_CONTROL;
+
+
+	// Single categories.
+	constexpr bool is_lu(char_t c) { return category(c) == CATEGORY_LU; }
+	constexpr bool is_ll(char_t c) { return category(c) == CATEGORY_LL; }
+	constexpr bool is_lt(char_t c) { return category(c) == CATEGORY_LT; }
+	constexpr bool is_lm(char_t c) { return category(c) == CATEGORY_LM; }
+	constexpr bool is_lo(char_t c) { return category(c) == CATEGORY_LO; }
+
+	constexpr bool is_mn(char_t c) { return category(c) == CATEGORY_MN; }
+	constexpr bool is_mc(char_t c) { return category(c) == CATEGORY_MC; }
+	constexpr bool is_me(char_t c) { return category(c) == CATEGORY_ME; }
+
+	constexpr bool is_nd(char_t c) { return category(c) == CATEGORY_ND; }
+	constexpr bool is_nl(char_t c) { return category(c) == CATEGORY_NL; }
+	constexpr bool is_no(char_t c) { return category(c) == CATEGORY_NO; }
+
+	constexpr bool is_pc(char_t c) { return category(c) == CATEGORY_PC; }
+	constexpr bool is_pd(char_t c) { return category(c) == CATEGORY_PD; }
+	constexpr bool is_ps(char_t c) { return category(c) == CATEGORY_PS; }
+	constexpr bool is_pe(char_t c) { return category(c) == CATEGORY_PE; }
+	constexpr bool is_pi(char_t c) { return category(c) == CATEGORY_PI; }
+	constexpr bool is_pf(char_t c) { return category(c) == CATEGORY_PF; }
+	constexpr bool is_po(char_t c) { return category(c) == CATEGORY_PO; }
+
+	constexpr bool is_sm(char_t c) { return category(c) == CATEGORY_SM; }
+	constexpr bool is_sc(char_t c) { return category(c) == CATEGORY_SC; }
+	constexpr bool is_sk(char_t c) { return category(c) == CATEGORY_SK; }
+	constexpr bool is_so(char_t c) { return category(c) == CATEGORY_SO; }
+
+	constexpr bool is_zs(char_t c) { return category(c) == CATEGORY_ZS; }
+	constexpr bool is_zl(char_t c) { return category(c) == CATEGORY_ZL; }
+	constexpr bool is_zp(char_t c) { return category(c) == CATEGORY_ZP; }
+
+	constexpr bool is_cc(char_t c) { return category(c) == CATEGORY_CC; }
+	constexpr bool is_cf(char_t c) { return category(c) == CATEGORY_CF; }
+	constexpr bool is_cs(char_t c) { return category(c) == CATEGORY_CS; }
+	constexpr bool is_co(char_t c) { return category(c) == CATEGORY_CO; }
+	constexpr bool is_cn(char_t c) { return category(c) == CATEGORY_CN; }
+
+
+	constexpr bool is_letter(char_t c) {
+		return has_property(c, PROPERTY_LETTER);
 	}
 
 	// things like accents.
-	inline bool is_mark(char_t c) {
-		return is_mn(c) or is_mc(c) or is_me(c);
+	constexpr bool is_mark(char_t c) {
+		return has_property(c, PROPERTY_MARK);
+	}
+
+	constexpr bool is_number(char_t c) {
+		return has_property(c, PROPERTY_NUMBER);
+	}
+
+	constexpr bool is_punctuation(char_t c) {
+		return has_property(c, PROPERTY_PUNCTUATION);
+	}
+
+	constexpr bool is_symbol(char_t c) {
+		return has_property(c, PROPERTY_SYMBOL);
+	}
+
+	constexpr bool is_seperator(char_t c) {
+		return has_property(c, PROPERTY_SEPERATOR);
+	}
+
+	constexpr bool is_control(char_t c) {
+		return has_property(c, PROPERTY_CONTROL);
+	}
+
+	constexpr bool is_other(char_t c) {
+		return is_category(c, CATEGORY_MASK_OTHER);
+	}
+
+	constexpr bool is_alphanumeric(char_t c) {
+		return has_property(c, PROPERTY_ALPHANUMERIC);
+	}
+
+	constexpr bool is_visible(char_t c) {
+		return has_property(c, PROPERTY_VISIBLE);
 	}
 
-	inline bool is_number(char_t c) {
-		return is_nd(c) or is_nl(c) or is_no(c);
+	constexpr bool is_whitespace(char_t c) {
+		return has_property(c, PROPERTY_WHITESPACE);
 	}
 
-	inline bool is_punctuation(char_t c) {
-		return is_pc(c) or is_pd(c) or is_ps(c) or is_pe(c) or is_pi(c) or is_pf(c) or is_po(c);
+
+	// Identifiers (UAX #31).
+	// Membership is stored as one bit per codepoint in 64 bit words
+	// and runs of identical words are shared through a two-stage
+	// table like the ones above.
+	namespace detail {
+		template <size_t Shift, size_t N1, size_t N2>
+		constexpr bool bitmap_lookup(char_t c, const u64_t(&ascii)[2], const u8_t(&stage1)[N1], const u64_t(&stage2)[N2]) {
+			if (c < 128)
+				return (ascii[c >> 6] >> (c & 63)) & 1;
+
+			if (c > 0x10FFFF)
+				return false;
+
+			const size_t word = c >> 6;
+			const size_t block = stage1[word >> Shift];
+			return (stage2[(block << Shift) | (word & ((1u << Shift) - 1))] >> (c & 63)) & 1;
+		}
+	}
+
+	// Can `c` begin an identifier?
+	// Note that this doesn't include `_`.
+	constexpr bool is_xid_start(char_t c) {
+		return detail::bitmap_lookup<INTERNAL_XID_START_SHIFT__>(
+			c, INTERNAL_XID_START_ASCII__, INTERNAL_XID_START_STAGE1__, INTERNAL_XID_START_STAGE2__);
+	}
+
+	// Can `c` appear after the first character of an identifier?
+	constexpr bool is_xid_continue(char_t c) {
+		return detail::bitmap_lookup<INTERNAL_XID_CONTINUE_SHIFT__>(
+			c, INTERNAL_XID_CONTINUE_ASCII__, INTERNAL_XID_CONTINUE_STAGE1__, INTERNAL_XID_CONTINUE_STAGE2__);
+	}
+
+
+	// Simple (one to one) case mapping.
+	// Each codepoint maps to an entry in a small table of
+	// (lower, upper, fold) deltas.
+	namespace detail {
+		enum {
+			CASE_LOWER,
+			CASE_UPPER,
+			CASE_FOLD,
+		};
+
+		constexpr const i32_t* case_deltas(char_t c) {
+			if (c > 0x10FFFF)
+				return INTERNAL_CASE_DELTAS__[0];
+
+			constexpr size_t shift = INTERNAL_CASE_SHIFT__;
+			constexpr char_t mask = (1u << shift) - 1;
+
+			const size_t block = INTERNAL_CASE_STAGE1__[c >> shift];
+			return INTERNAL_CASE_DELTAS__[INTERNAL_CASE_STAGE2__[(block << shift) | (c & mask)]];
+		}
+
+		// ASCII letters differ only in bit 5.
+		constexpr char_t ascii_change_case(char_t c, char_t lo) {
+			return c ^ (((char_t)(c - lo) < 26) << 5);
+		}
 	}
 
-	inline bool is_symbol(char_t c) {
-		return is_sm(c) or is_sc(c) or is_sk(c) or is_so(c);
+	constexpr char_t to_lower(char_t c) {
+		if (c < 128)
+			return detail::ascii_change_case(c, 'A');
+
+		return c + detail::case_deltas(c)[detail::CASE_LOWER];
 	}
 
-	inline bool is_seperator(char_t c) {
-		return is_zs(c) or is_zl(c) or is_zp(c);
+	constexpr char_t to_upper(char_t c) {
+		if (c < 128)
+			return detail::ascii_change_case(c, 'a');
+
+		return c + detail::case_deltas(c)[detail::CASE_UPPER];
+	}
+
+	// Simple case folding for caseless matching.
+	constexpr char_t fold_case(char_t c) {
+		if (c < 128)
+			return detail::ascii_change_case(c, 'A');
+
+		return c + detail::case_deltas(c)[detail::CASE_FOLD];
+	}
+
+
+	namespace detail {
+		// Flip bit 5 of every byte in `lo..lo+25`. Bytes must be ASCII
+		// so that adding to a lane can't carry into the next one.
+		constexpr u64_t swar_change_case(u64_t x, u8_t lo) {
+			const u64_t above_lo = x + swar_broadcast(0x80 - lo);
+			const u64_t above_hi = x + swar_broadcast(0x80 - lo - 26);
+			return x ^ (((above_lo & ~above_hi) & SWAR_HIGH) >> 2);
+		}
+
+	#if defined(BR_SIMD_AVX2)
+		inline __m256i change_case_avx2(__m256i x, u8_t lo) {
+			const __m256i in_range = _mm256_and_si256(
+				_mm256_cmpgt_epi8(x, _mm256_set1_epi8(lo - 1)),
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(lo + 26), x));
+
+			return _mm256_xor_si256(x, _mm256_and_si256(in_range, _mm256_set1_epi8(0x20)));
+		}
+
+	#elif defined(BR_SIMD_SSE42)
+		inline __m128i change_case_sse42(__m128i x, u8_t lo) {
+			const __m128i in_range = _mm_and_si128(
+				_mm_cmpgt_epi8(x, _mm_set1_epi8(lo - 1)),
+				_mm_cmpgt_epi8(_mm_set1_epi8(lo + 26), x));
+
+			return _mm_xor_si128(x, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+		}
+	#endif
+
+		// Change the case of ASCII bytes from `ptr` into `out`
+		// stopping at the first non-ASCII byte.
+		inline const char* change_case_ascii(const char* ptr, const char* const end, char*& out, u8_t lo) {
+		#if defined(BR_SIMD_AVX2)
+			for (; end - ptr >= 32; ptr += 32, out += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+
+				if (_mm256_movemask_epi8(x))
+					break;
+
+				_mm256_storeu_si256((__m256i*)out, change_case_avx2(x, lo));
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			for (; end - ptr >= 16; ptr += 16, out += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+				if (_mm_movemask_epi8(x))
+					break;
+
+				_mm_storeu_si128((__m128i*)out, change_case_sse42(x, lo));
+			}
+		#endif
+
+			for (; end - ptr >= 8; ptr += 8, out += 8) {
+				const u64_t x = load<u64_t>(ptr);
+
+				if (x & SWAR_HIGH)
+					break;
+
+				store(out, swar_change_case(x, lo));
+			}
+
+			for (; ptr != end and (u8_t)*ptr < 0x80; ++ptr)
+				*out++ = ascii_change_case(*ptr, lo);
+
+			return ptr;
+		}
+
+		template <char_t (*Map)(char_t)>
+		[[nodiscard]] inline vec<char> change_case(str_view sv, vec<char> v, u8_t lo) {
+			// A mapping can grow a codepoint from 2 to 3 bytes.
+			const size_t n = length(sv) + length(sv) / 2 + 1;
+
+			v = reserve(v, n);
+			char* out = v.data + v.used;
+
+			while (not eof(sv)) {
+				sv.begin = change_case_ascii(sv.begin, sv.end, out, lo);
+
+				if (eof(sv))
+					break;
+
+				char_t c;
+				sv = iter_next_char(sv, c);
+				out += utf_char_encode(Map(c), out);
+			}
+
+			v.used = out - v.data;
+			return v;
+		}
 	}
 
-	inline bool is_control(char_t c) {
-		return is_cc(c) or is_cf(c);
+
+	// Append a lowercase/uppercase copy of `sv` to `v`.
+	[[nodiscard]] inline vec<char> to_lower(str_view sv, vec<char> v) {
+		return detail::change_case<to_lower>(sv, v, 'A');
 	}
 
-	inline bool is_other(char_t c) {
-		return is_cc(c) or is_cf(c) or is_cs(c) or is_co(c);
+	[[nodiscard]] inline vec<char> to_upper(str_view sv, vec<char> v) {
+		return detail::change_case<to_upper>(sv, v, 'a');
 	}
 
-	inline bool is_alphanumeric(char_t c) {
-		return is_letter(c) or is_number(c);
+	// Make a new lowercase/uppercase copy of `sv`.
+	// The result must be freed with `destroy_vec`.
+	[[nodiscard]] inline vec<char> to_lower(str_view sv) {
+		return to_lower(sv, make_vec<char>());
 	}
 
-	inline bool is_visible(char_t c) {
-		return is_alphanumeric(c) or is_symbol(c) or is_punctuation(c);
+	[[nodiscard]] inline vec<char> to_upper(str_view sv) {
+		return to_upper(sv, make_vec<char>());
 	}
 
-	inline bool is_whitespace(char_t c) {
-		return is_zs(c) or is_control(c);
+
+	namespace detail {
+		// Compare ASCII bytes case insensitively until either string
+		// reaches a non-ASCII byte. Returns false on a mismatch.
+		inline bool eq_fold_ascii(const char*& a, const char* const a_end, const char*& b, const char* const b_end) {
+		#if defined(BR_SIMD_AVX2)
+			for (; a_end - a >= 32 and b_end - b >= 32; a += 32, b += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)a);
+				const __m256i y = _mm256_loadu_si256((const __m256i*)b);
+
+				if (_mm256_movemask_epi8(_mm256_or_si256(x, y)))
+					break;
+
+				const __m256i eq = _mm256_cmpeq_epi8(change_case_avx2(x, 'A'), change_case_avx2(y, 'A'));
+
+				if (~(u32_t)_mm256_movemask_epi8(eq))
+					return false;
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			for (; a_end - a >= 16 and b_end - b >= 16; a += 16, b += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)a);
+				const __m128i y = _mm_loadu_si128((const __m128i*)b);
+
+				if (_mm_movemask_epi8(_mm_or_si128(x, y)))
+					break;
+
+				const __m128i eq = _mm_cmpeq_epi8(change_case_sse42(x, 'A'), change_case_sse42(y, 'A'));
+
+				if (_mm_movemask_epi8(eq) != 0xFFFF)
+					return false;
+			}
+		#endif
+
+			for (; a_end - a >= 8 and b_end - b >= 8; a += 8, b += 8) {
+				const u64_t x = load<u64_t>(a);
+				const u64_t y = load<u64_t>(b);
+
+				if ((x | y) & SWAR_HIGH)
+					break;
+
+				if (swar_change_case(x, 'A') != swar_change_case(y, 'A'))
+					return false;
+			}
+
+			for (; a != a_end and b != b_end and (u8_t)*a < 0x80 and (u8_t)*b < 0x80; ++a, ++b) {
+				if (ascii_change_case(*a, 'A') != ascii_change_case(*b, 'A'))
+					return false;
+			}
+
+			return true;
+		}
+	}
+
+	// Compare two strings under simple case folding.
+	// The strings can differ in byte length (i.e. `K` and KELVIN SIGN).
+	constexpr bool eq_fold(str_view a, str_view b) {
+		while (not eof(a) and not eof(b)) {
+			if (not is_constant_evaluated() and not detail::eq_fold_ascii(a.begin, a.end, b.begin, b.end))
+				return false;
+
+			if (eof(a) or eof(b))
+				break;
+
+			char_t x = 0;
+			char_t y = 0;
+
+			a = iter_next_char(a, x);
+			b = iter_next_char(b, y);
+
+			if (fold_case(x) != fold_case(y))
+				return false;
+		}
+
+		return eof(a) and eof(b);
+	}
+
+
+	// Bulk classification.
+	// ASCII is classified a vector at a time by treating the 128
+	// entry property table as 8 rows of 16 and selecting a row per
+	// byte with its high nibble. Multibyte characters are decoded
+	// and looked up in the trie. Input must be valid UTF-8.
+
+	namespace detail {
+		// For every property bit, a table indexed by low nibble with
+		// a bit set for every high nibble of an ASCII byte that has
+		// the property. OR-ing the rows for the bits in a mask gives
+		// a `byte_set` style table for that mask.
+		struct property_nibbles {
+			u8_t lo[8][16] {};
+		};
+
+		constexpr property_nibbles make_property_nibbles() {
+			property_nibbles pn;
+
+			for (u8_t c = 0; c != length(INTERNAL_PROPERTY_ASCII__); ++c) {
+				for (u8_t bit = 0; bit != 8; ++bit) {
+					if (INTERNAL_PROPERTY_ASCII__[c] & (1u << bit))
+						pn.lo[bit][c & 0x0F] |= 1u << (c >> 4);
+				}
+			}
+
+			return pn;
+		}
+
+		constexpr property_nibbles INTERNAL_PROPERTY_NIBBLES__ = make_property_nibbles();
+
+		// Scalar ASCII paths. These stop at the first non-ASCII byte.
+		constexpr const char* span_ascii(const char* ptr, const char* const end, property_t mask) {
+			for (; ptr != end and (u8_t)*ptr < 0x80 and (INTERNAL_PROPERTY_ASCII__[(u8_t)*ptr] & mask); ++ptr) {}
+			return ptr;
+		}
+
+		constexpr const char* classify_ascii(const char* ptr, const char* const end, property_t*& out) {
+			for (; ptr != end and (u8_t)*ptr < 0x80; ++ptr)
+				*out++ = INTERNAL_PROPERTY_ASCII__[(u8_t)*ptr];
+
+			return ptr;
+		}
+
+	#if defined(BR_SIMD_AVX2)
+		inline __m256i property_nibble_table(property_t mask) {
+			__m128i lo = _mm_setzero_si128();
+
+			for (u8_t bit = 0; bit != 8; ++bit) {
+				if (mask & (1u << bit))
+					lo = _mm_or_si128(lo, _mm_loadu_si128((const __m128i*)INTERNAL_PROPERTY_NIBBLES__.lo[bit]));
+			}
+
+			return _mm256_broadcastsi128_si256(lo);
+		}
+
+		inline const char* span_ascii_wide(const char* ptr, const char* const end, property_t mask) {
+			// Most tokens are short so try a few bytes before paying
+			// for building the tables.
+			const char* const limit = ptr + min<offset_t>(end - ptr, 16);
+			ptr = span_ascii(ptr, limit, mask);
+
+			if (ptr != limit)
+				return ptr;
+
+			const __m256i lo = property_nibble_table(mask);
+			const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)INTERNAL_NIBBLE_BIT__));
+			const __m256i nibble = _mm256_set1_epi8(0x0F);
+			const __m256i zero = _mm256_setzero_si256();
+
+			// Non-ASCII bytes have a high nibble of 8 or more which
+			// maps to zero so they always end the span.
+			for (; end - ptr >= 32; ptr += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+
+				const __m256i matches = _mm256_and_si256(
+					_mm256_shuffle_epi8(lo, _mm256_and_si256(x, nibble)),
+					_mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+
+				const u32_t stop = _mm256_movemask_epi8(_mm256_cmpeq_epi8(matches, zero));
+
+				if (stop)
+					return ptr + countr_zero(stop);
+			}
+
+			return span_ascii(ptr, end, mask);
+		}
+
+		inline const char* classify_ascii_wide(const char* ptr, const char* const end, property_t*& out) {
+			const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+			// Only store whole vectors of ASCII so that we never write
+			// more properties than there are codepoints.
+			for (; end - ptr >= 32; ptr += 32, out += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+
+				if (_mm256_movemask_epi8(x))
+					break;
+
+				const __m256i lo = _mm256_and_si256(x, nibble);
+				const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+
+				__m256i props = _mm256_setzero_si256();
+
+				for (u8_t row = 0; row != 8; ++row) {
+					const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(INTERNAL_PROPERTY_ASCII__ + row * 16)));
+					const __m256i select = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(row));
+
+					props = _mm256_or_si256(props, _mm256_and_si256(select, _mm256_shuffle_epi8(table, lo)));
+				}
+
+				_mm256_storeu_si256((__m256i*)out, props);
+			}
+
+			return classify_ascii(ptr, end, out);
+		}
+
+	#elif defined(BR_SIMD_SSE42)
+		inline __m128i property_nibble_table(property_t mask) {
+			__m128i lo = _mm_setzero_si128();
+
+			for (u8_t bit = 0; bit != 8; ++bit) {
+				if (mask & (1u << bit))
+					lo = _mm_or_si128(lo, _mm_loadu_si128((const __m128i*)INTERNAL_PROPERTY_NIBBLES__.lo[bit]));
+			}
+
+			return lo;
+		}
+
+		inline const char* span_ascii_wide(const char* ptr, const char* const end, property_t mask) {
+			const char* const limit = ptr + min<offset_t>(end - ptr, 16);
+			ptr = span_ascii(ptr, limit, mask);
+
+			if (ptr != limit)
+				return ptr;
+
+			const __m128i lo = property_nibble_table(mask);
+			const __m128i hi = _mm_loadu_si128((const __m128i*)INTERNAL_NIBBLE_BIT__);
+			const __m128i nibble = _mm_set1_epi8(0x0F);
+			const __m128i zero = _mm_setzero_si128();
+
+			for (; end - ptr >= 16; ptr += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+				const __m128i matches = _mm_and_si128(
+					_mm_shuffle_epi8(lo, _mm_and_si128(x, nibble)),
+					_mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), nibble)));
+
+				const u32_t stop = _mm_movemask_epi8(_mm_cmpeq_epi8(matches, zero));
+
+				if (stop)
+					return ptr + countr_zero(stop);
+			}
+
+			return span_ascii(ptr, end, mask);
+		}
+
+		inline const char* classify_ascii_wide(const char* ptr, const char* const end, property_t*& out) {
+			const __m128i nibble = _mm_set1_epi8(0x0F);
+
+			for (; end - ptr >= 16; ptr += 16, out += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+				if (_mm_movemask_epi8(x))
+					break;
+
+				const __m128i lo = _mm_and_si128(x, nibble);
+				const __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+
+				__m128i props = _mm_setzero_si128();
+
+				for (u8_t row = 0; row != 8; ++row) {
+					const __m128i table = _mm_loadu_si128((const __m128i*)(INTERNAL_PROPERTY_ASCII__ + row * 16));
+					const __m128i select = _mm_cmpeq_epi8(hi, _mm_set1_epi8(row));
+
+					props = _mm_or_si128(props, _mm_and_si128(select, _mm_shuffle_epi8(table, lo)));
+				}
+
+				_mm_storeu_si128((__m128i*)out, props);
+			}
+
+			return classify_ascii(ptr, end, out);
+		}
+
+	#else
+		inline const char* span_ascii_wide(const char* ptr, const char* const end, property_t mask) {
+			return span_ascii(ptr, end, mask);
+		}
+
+		inline const char* classify_ascii_wide(const char* ptr, const char* const end, property_t*& out) {
+			return classify_ascii(ptr, end, out);
+		}
+	#endif
+	}
+
+
+	// Write the properties of every codepoint in `sv` to `out`
+	// which must have room for `utf_length(sv)` entries.
+	// Returns the number of codepoints classified.
+	constexpr size_t classify(str_view sv, property_t* out) {
+		const auto first = out;
+
+		while (not eof(sv)) {
+			sv.begin = is_constant_evaluated() ?
+				detail::classify_ascii(sv.begin, sv.end, out) :
+				detail::classify_ascii_wide(sv.begin, sv.end, out);
+
+			if (eof(sv))
+				break;
+
+			char_t c = 0;
+			sv = iter_next_char(sv, c);
+			*out++ = properties(c);
+		}
+
+		return out - first;
+	}
+
+	// Skip the leading run of codepoints which have any of the
+	// properties in `mask` and return the rest of `sv`.
+	// i.e.
+	//     auto rest = span_while(sv, PROPERTY_ALPHANUMERIC);
+	//     auto ident = make_sv(sv.begin, rest.begin);
+	constexpr str_view span_while(str_view sv, property_t mask) {
+		while (not eof(sv)) {
+			sv.begin = is_constant_evaluated() ?
+				detail::span_ascii(sv.begin, sv.end, mask) :
+				detail::span_ascii_wide(sv.begin, sv.end, mask);
+
+			// Stopped on ASCII that doesn't match.
+			if (eof(sv) or (u8_t)*sv.begin < 0x80)
+				break;
+
+			char_t c = 0;
+			const auto next = iter_next_char(sv, c);
+
+			if (not (properties(c) & mask))
+				break;
+
+			sv = next;
+		}
+
+		return sv;
+	}
+
+
+	// Normalization (UAX #15).
+	// Every codepoint maps to its canonical combining class and
+	// NFC_Quick_Check value with one trie lookup. Almost all text is
+	// already in NFC so we only check it and hand back the same view.
+	// Runs that fail the check are decomposed, reordered and
+	// recomposed on their own while everything around them is copied
+	// as is.
+	namespace detail {
+		constexpr const u8_t* normalization_info(char_t c) {
+			if (c > 0x10FFFF)
+				return INTERNAL_NORMALIZATION_INFO__[0];
+
+			constexpr size_t shift = INTERNAL_NORMALIZATION_SHIFT__;
+			constexpr char_t mask = (1u << shift) - 1;
+
+			const size_t block = INTERNAL_NORMALIZATION_STAGE1__[c >> shift];
+			return INTERNAL_NORMALIZATION_INFO__[INTERNAL_NORMALIZATION_STAGE2__[(block << shift) | (c & mask)]];
+		}
+
+		// Hangul syllables are composed from jamo arithmetically.
+		constexpr char_t HANGUL_S = 0xAC00;
+		constexpr char_t HANGUL_L = 0x1100;
+		constexpr char_t HANGUL_V = 0x1161;
+		constexpr char_t HANGUL_T = 0x11A7;
+
+		constexpr char_t HANGUL_L_COUNT = 19;
+		constexpr char_t HANGUL_V_COUNT = 21;
+		constexpr char_t HANGUL_T_COUNT = 28;
+		constexpr char_t HANGUL_N_COUNT = HANGUL_V_COUNT * HANGUL_T_COUNT;
+		constexpr char_t HANGUL_S_COUNT = HANGUL_L_COUNT * HANGUL_N_COUNT;
+	}
+
+	constexpr u8_t combining_class(char_t c) {
+		return detail::normalization_info(c)[0];
+	}
+
+	constexpr quick_check_t nfc_quick_check(char_t c) {
+		return detail::normalization_info(c)[1];
+	}
+
+
+	namespace detail {
+		// Append the full canonical decomposition of `c`.
+		template <typename A>
+		[[nodiscard]] inline vec<char_t, A> decompose(char_t c, vec<char_t, A> v) {
+			if (c - HANGUL_S < HANGUL_S_COUNT) {
+				const char_t s = c - HANGUL_S;
+
+				v = push(v, HANGUL_L + s / HANGUL_N_COUNT);
+				v = push(v, HANGUL_V + (s % HANGUL_N_COUNT) / HANGUL_T_COUNT);
+
+				if (s % HANGUL_T_COUNT)
+					v = push(v, HANGUL_T + s % HANGUL_T_COUNT);
+
+				return v;
+			}
+
+			if (c > 0x10FFFF)
+				return push(v, c);
+
+			constexpr size_t shift = INTERNAL_DECOMPOSITION_SHIFT__;
+			constexpr char_t mask = (1u << shift) - 1;
+
+			const size_t block = INTERNAL_DECOMPOSITION_STAGE1__[c >> shift];
+			const u16_t entry = INTERNAL_DECOMPOSITION_STAGE2__[(block << shift) | (c & mask)];
+
+			if (entry == 0)
+				return push(v, c);
+
+			for (index_t i = 0; i != (entry & 7u); ++i)
+				v = push(v, (char_t)INTERNAL_DECOMPOSITION_DATA__[(entry >> 3) + i]);
+
+			return v;
+		}
+
+		// Primary composite of a pair or 0 if there isn't one.
+		constexpr char_t compose(char_t a, char_t b) {
+			if (a - HANGUL_L < HANGUL_L_COUNT and b - HANGUL_V < HANGUL_V_COUNT)
+				return HANGUL_S + ((a - HANGUL_L) * HANGUL_V_COUNT + (b - HANGUL_V)) * HANGUL_T_COUNT;
+
+			if (a - HANGUL_S < HANGUL_S_COUNT and (a - HANGUL_S) % HANGUL_T_COUNT == 0 and b - HANGUL_T - 1 < HANGUL_T_COUNT - 1)
+				return a + (b - HANGUL_T);
+
+			const u64_t key = ((u64_t)a << 21) | b;
+
+			size_t lo = 0;
+			size_t hi = length(INTERNAL_COMPOSITION_KEYS__);
+
+			while (lo != hi) {
+				const size_t mid = lo + (hi - lo) / 2;
+
+				if (INTERNAL_COMPOSITION_KEYS__[mid] < key)
+					lo = mid + 1;
+
+				else
+					hi = mid;
+			}
+
+			if (lo != length(INTERNAL_COMPOSITION_KEYS__) and INTERNAL_COMPOSITION_KEYS__[lo] == key)
+				return INTERNAL_COMPOSITION_VALUES__[lo];
+
+			return 0;
+		}
+
+		template <typename A>
+		[[nodiscard]] inline vec<char, A> nfc_append(vec<char, A> v, str_view sv) {
+			const size_t n = length(sv);
+
+			if (capacity(v) - length(v) < n)
+				v = reserve(v, max(n, capacity(v) / 2));
+
+			std::memcpy(v.data + v.used, sv.begin, n);
+			v.used += n;
+
+			return v;
+		}
+
+		// Normalize a run and append it to `v`. `cps` is scratch space
+		// for the decomposed codepoints.
+		template <typename A>
+		[[nodiscard]] inline vec<char, A> nfc_run(str_view sv, vec<char, A> v, vec<char_t, A>& cps) {
+			cps.used = 0;
+
+			while (not eof(sv)) {
+				char_t c = 0;
+				sv = iter_next_char(sv, c);
+				cps = decompose(c, cps);
+			}
+
+			char_t* const buf = cps.data;
+			const size_t n = length(cps);
+
+			// Canonical ordering: stable sort each sequence of
+			// non-starters by combining class.
+			for (index_t i = 1; i < n; ++i) {
+				const char_t c = buf[i];
+				const u8_t ccc = combining_class(c);
+
+				if (ccc == 0)
+					continue;
+
+				index_t j = i;
+
+				for (; j > 0 and combining_class(buf[j - 1]) > ccc; --j)
+					buf[j] = buf[j - 1];
+
+				buf[j] = c;
+			}
+
+			// Canonical composition. A character combines with the
+			// last starter unless something in between is blocking it
+			// (has a combining class of 0 or at least its own).
+			size_t used = min<size_t>(n, 1);
+
+			if (n != 0) {
+				index_t starter = 0;
+				u8_t last = combining_class(buf[0]) == 0 ? 0 : 255;
+
+				for (index_t i = 1; i != n; ++i) {
+					const char_t c = buf[i];
+					const u8_t ccc = combining_class(c);
+					const char_t composite = (last < ccc or last == 0) ? compose(buf[starter], c) : 0;
+
+					if (composite != 0) {
+						buf[starter] = composite;
+						continue;
+					}
+
+					if (ccc == 0)
+						starter = used;
+
+					last = ccc;
+					buf[used++] = c;
+				}
+			}
+
+			if (capacity(v) - length(v) < used * 4)
+				v = reserve(v, max(used * 4, capacity(v) / 2));
+
+			v.used += utf_encode(buf, used, v.data + v.used);
+			return v;
+		}
+
+		// Every codepoint below U+0300 is a starter which never
+		// combines with what comes before it. Their UTF-8 lead bytes
+		// are all below 0xCC so we can skip to the first byte that
+		// isn't.
+		inline const char* nfc_skip(const char* ptr, const char* const end) {
+		#if defined(BR_SIMD_AVX2)
+			const __m256i lo = _mm256_set1_epi8((char)0xCC);
+
+			for (; end - ptr >= 32; ptr += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+				const u32_t stop = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(x, lo), x));
+
+				if (stop)
+					return ptr + countr_zero(stop);
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i lo = _mm_set1_epi8((char)0xCC);
+
+			for (; end - ptr >= 16; ptr += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+				const u32_t stop = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(x, lo), x));
+
+				if (stop)
+					return ptr + countr_zero(stop);
+			}
+		#endif
+
+			for (; end - ptr >= 8 and not (load<u64_t>(ptr) & SWAR_HIGH); ptr += 8) {}
+			for (; ptr != end and (u8_t)*ptr < 0xCC; ++ptr) {}
+
+			return ptr;
+		}
+	}
+
+
+	// NFC_Quick_Check of a whole string. `QUICK_CHECK_MAYBE` means
+	// the string has to be normalized to find out.
+	inline quick_check_t nfc_quick_check(str_view sv) {
+		quick_check_t result = QUICK_CHECK_YES;
+		u8_t last = 0;
+
+		while (not eof(sv)) {
+			if ((u8_t)*sv.begin < 0xCC) {
+				sv.begin = detail::nfc_skip(sv.begin + 1, sv.end);
+				last = 0;
+				continue;
+			}
+
+			char_t c = 0;
+			sv = iter_next_char(sv, c);
+
+			const auto info = detail::normalization_info(c);
+
+			if ((info[0] != 0 and last > info[0]) or info[1] == QUICK_CHECK_NO)
+				return QUICK_CHECK_NO;
+
+			if (info[1] == QUICK_CHECK_MAYBE)
+				result = QUICK_CHECK_MAYBE;
+
+			last = info[0];
+		}
+
+		return result;
+	}
+
+	// Normalize `sv` to NFC. Input must be valid UTF-8.
+	// If it's already normalized `out` is `sv` itself and nothing is
+	// copied. Otherwise the normalized string is appended to `v` and
+	// `out` points into it (so it's invalidated when `v` grows).
+	// Scratch space comes from the same allocator as `v`.
+	template <typename A>
+	[[nodiscard]] inline vec<char, A> nfc(str_view sv, vec<char, A> v, str_view& out) {
+		const size_t first = length(v);
+
+		const char* ptr = sv.begin;
+		const char* done = sv.begin;  // Input before this has been written to `v`.
+		const char* run = sv.begin;   // Last starter that can't combine backwards.
+
+		bool dirty = false;
+		u8_t last = 0;
+
+		vec<char_t, A> cps {};  // Only allocated if something needs normalizing.
+
+		const auto flush = [&] (const char* const end) {
+			if (cps.data == nullptr)
+				cps = make_vec<char_t>(allocator(v));
+
+			dirty = false;
+
+			const size_t mark = length(v);
+			const size_t gap = run - done;
+
+			v = detail::nfc_run(make_sv(run, end), v, cps);
+
+			// Quick check answered maybe and the run was already
+			// normalized so leave it to be copied with its neighbours.
+			if (eq(make_sv(v.data + mark, v.data + v.used), make_sv(run, end))) {
+				v.used = mark;
+				return;
+			}
+
+			// Insert the untouched input since the last run in front.
+			if (capacity(v) - length(v) < gap)
+				v = reserve(v, max(gap, capacity(v) / 2));
+
+			std::memmove(v.data + mark + gap, v.data + mark, length(v) - mark);
+			std::memcpy(v.data + mark, done, gap);
+
+			v.used += gap;
+			done = end;
+		};
+
+		while (ptr != sv.end) {
+			if ((u8_t)*ptr < 0xCC) {
+				if (dirty)
+					flush(ptr);
+
+				// The run can start at the last character we skip.
+				ptr = detail::nfc_skip(ptr + 1, sv.end);
+				run = ptr - 1;
+
+				while (((u8_t)*run & 0xC0) == 0x80)
+					--run;
+
+				last = 0;
+				continue;
+			}
+
+			char_t c = 0;
+			const char* next = iter_next_char(make_sv(ptr, sv.end), c).begin;
+
+			const auto info = detail::normalization_info(c);
+
+			if (info[0] == 0 and info[1] == QUICK_CHECK_YES) {
+				if (dirty)
+					flush(ptr);
+
+				run = ptr;
+			}
+
+			else if (info[1] != QUICK_CHECK_YES or (info[0] != 0 and last > info[0]))
+				dirty = true;
+
+			last = info[0];
+			ptr = next;
+		}
+
+		if (dirty)
+			flush(sv.end);
+
+		cps = destroy_vec(cps);
+
+		if (done == sv.begin) {
+			out = sv;
+			return v;
+		}
+
+		v = detail::nfc_append(v, make_sv(done, sv.end));
+		out = make_sv(v.data + first, v.data + v.used);
+
+		return v;
+	}
+
+	// Check if a string is in NFC.
+	inline bool is_nfc(str_view sv) {
+		const auto qc = nfc_quick_check(sv);
+
+		if (qc != QUICK_CHECK_MAYBE)
+			return qc == QUICK_CHECK_YES;
+
+		str_view normalized;
+		auto v = nfc(sv, make_vec<char>(), normalized);
+
+		const bool result = eq(sv, normalized);
+		v = destroy_vec(v);
+
+		return result;
+	}
+
+
+	// Grapheme clusters (UAX #29).
+	// Clusters are what a user thinks of as a character, i.e. a
+	// letter with its accents or a flag made from two regional
+	// indicators. Input must be valid UTF-8.
+	constexpr grapheme_break_t grapheme_break(char_t c) {
+		if (c > 0x10FFFF)
+			return GRAPHEME_BREAK_OTHER;
+
+		constexpr size_t shift = INTERNAL_GRAPHEME_BREAK_SHIFT__;
+		constexpr char_t mask = (1u << shift) - 1;
+
+		const size_t block = INTERNAL_GRAPHEME_BREAK_STAGE1__[c >> shift];
+		return INTERNAL_GRAPHEME_BREAK_STAGE2__[(block << shift) | (c & mask)];
+	}
+
+	namespace detail {
+		// Is there a boundary between two codepoints? Rules GB11 and
+		// GB12/13 look further back so their state is passed in:
+		// `emoji` if `a` is a ZWJ after an extended pictographic and
+		// its extends and `odd_regional` if `a` ends an odd run of
+		// regional indicators.
+		constexpr bool grapheme_boundary(grapheme_break_t a, grapheme_break_t b, bool emoji, bool odd_regional) {
+			if (a == GRAPHEME_BREAK_CR and b == GRAPHEME_BREAK_LF)
+				return false;
+
+			if (a == GRAPHEME_BREAK_CR or a == GRAPHEME_BREAK_LF or a == GRAPHEME_BREAK_CONTROL)
+				return true;
+
+			if (b == GRAPHEME_BREAK_CR or b == GRAPHEME_BREAK_LF or b == GRAPHEME_BREAK_CONTROL)
+				return true;
+
+			switch (a) {
+				case GRAPHEME_BREAK_L:
+					if (b == GRAPHEME_BREAK_L or b == GRAPHEME_BREAK_V or b == GRAPHEME_BREAK_LV or b == GRAPHEME_BREAK_LVT)
+						return false;
+					break;
+
+				case GRAPHEME_BREAK_LV:
+				case GRAPHEME_BREAK_V:
+					if (b == GRAPHEME_BREAK_V or b == GRAPHEME_BREAK_T)
+						return false;
+					break;
+
+				case GRAPHEME_BREAK_LVT:
+				case GRAPHEME_BREAK_T:
+					if (b == GRAPHEME_BREAK_T)
+						return false;
+					break;
+			}
+
+			if (b == GRAPHEME_BREAK_EXTEND or b == GRAPHEME_BREAK_ZWJ or b == GRAPHEME_BREAK_SPACING_MARK)
+				return false;
+
+			if (a == GRAPHEME_BREAK_PREPEND)
+				return false;
+
+			if (a == GRAPHEME_BREAK_ZWJ and b == GRAPHEME_BREAK_PICTOGRAPHIC and emoji)
+				return false;
+
+			if (a == GRAPHEME_BREAK_REGIONAL_INDICATOR and b == GRAPHEME_BREAK_REGIONAL_INDICATOR and odd_regional)
+				return false;
+
+			return true;
+		}
+	}
+
+	// Skip the first grapheme cluster of `sv` and return the rest.
+	constexpr str_view next_grapheme(str_view sv) {
+		if (eof(sv))
+			return sv;
+
+		// An ASCII byte followed by another is a cluster of its own
+		// unless it's CR LF.
+		if ((u8_t)sv.begin[0] < 0x80 and (length(sv) == 1 or (u8_t)sv.begin[1] < 0x80)) {
+			const bool crlf = length(sv) > 1 and sv.begin[0] == '\r' and sv.begin[1] == '\n';
+			return next_byte(sv, 1 + crlf);
+		}
+
+		char_t c = 0;
+		sv = iter_next_char(sv, c);
+
+		grapheme_break_t prev = grapheme_break(c);
+
+		bool pictographic = prev == GRAPHEME_BREAK_PICTOGRAPHIC;  // ExtPict Extend*
+		bool emoji = false;                                      // ExtPict Extend* ZWJ
+		size_t regional = prev == GRAPHEME_BREAK_REGIONAL_INDICATOR;
+
+		while (not eof(sv)) {
+			// Only a prepend joins with a following ASCII character
+			// (CR LF was handled above).
+			if ((u8_t)*sv.begin < 0x80 and prev != GRAPHEME_BREAK_PREPEND)
+				break;
+
+			const auto next = iter_next_char(sv, c);
+			const grapheme_break_t cur = grapheme_break(c);
+
+			if (detail::grapheme_boundary(prev, cur, emoji, regional & 1))
+				break;
+
+			emoji = pictographic and cur == GRAPHEME_BREAK_ZWJ;
+			pictographic = cur == GRAPHEME_BREAK_PICTOGRAPHIC or (pictographic and cur == GRAPHEME_BREAK_EXTEND);
+			regional = cur == GRAPHEME_BREAK_REGIONAL_INDICATOR ? regional + 1 : 0;
+
+			prev = cur;
+			sv = next;
+		}
+
+		return sv;
+	}
+
+	// Split off the first grapheme cluster.
+	// i.e.
+	//     str_view cluster;
+	//     while (not eof(sv))
+	//         sv = iter_next_grapheme(sv, cluster);
+	[[nodiscard]] constexpr str_view iter_next_grapheme(str_view sv, str_view& cluster) {
+		const auto rest = next_grapheme(sv);
+		cluster = make_sv(sv.begin, rest.begin);
+		return rest;
+	}
+
+	// Number of grapheme clusters.
+	// ASCII runs are counted in bulk: every byte but the last is a
+	// cluster of its own except for CR LF pairs. The last one is left
+	// to `next_grapheme` since it can be followed by a combining mark.
+	constexpr size_t grapheme_length(str_view sv) {
+		size_t count = 0;
+
+		while (not eof(sv)) {
+			const size_t n = ascii_length(sv);
+
+			if (n > 1) {
+				size_t k = n - 1;
+
+				// Don't split a CR LF pair.
+				if (sv.begin[k - 1] == '\r' and sv.begin[k] == '\n')
+					--k;
+
+				size_t pairs = 0;
+
+				for (auto it = make_sv(sv.begin, sv.begin + k); not eof(it = find_byte(it, '\r')); it = next_byte(it))
+					pairs += length(it) > 1 and it.begin[1] == '\n';
+
+				count += k - pairs;
+				sv = next_byte(sv, k);
+			}
+
+			sv = next_grapheme(sv);
+			count++;
+		}
+
+		return count;
+	}
+
+
+	// Display width.
+	// Number of terminal columns a codepoint takes: 2 for East Asian
+	// wide and fullwidth characters, 0 for controls, marks that
+	// don't take up space of their own and format characters, and 1
+	// for everything else.
+	constexpr u8_t display_width(char_t c) {
+		if (c < 128)
+			return c >= 0x20 and c != 0x7F;
+
+		if (c > 0x10FFFF)
+			return 1;
+
+		constexpr size_t shift = INTERNAL_WIDTH_SHIFT__;
+		constexpr char_t mask = (1u << shift) - 1;
+
+		const size_t block = INTERNAL_WIDTH_STAGE1__[c >> shift];
+		return INTERNAL_WIDTH_STAGE2__[(block << shift) | (c & mask)];
+	}
+
+	namespace detail {
+		// Sum the widths of ASCII bytes (printable ones take a column)
+		// until the first non-ASCII byte.
+		constexpr const char* ascii_width(const char* ptr, const char* const end, size_t& width) {
+			for (; ptr != end and (u8_t)*ptr < 0x80; ++ptr)
+				width += (u8_t)*ptr >= 0x20 and *ptr != 0x7F;
+
+			return ptr;
+		}
+
+		inline const char* ascii_width_wide(const char* ptr, const char* const end, size_t& width) {
+		#if defined(BR_SIMD_AVX2)
+			const __m256i space = _mm256_set1_epi8(0x20);
+			const __m256i del = _mm256_set1_epi8(0x7F);
+
+			for (; end - ptr >= 32; ptr += 32) {
+				const __m256i x = _mm256_loadu_si256((const __m256i*)ptr);
+
+				if (_mm256_movemask_epi8(x))
+					break;
+
+				const u32_t control = _mm256_movemask_epi8(_mm256_or_si256(
+					_mm256_cmpgt_epi8(space, x),
+					_mm256_cmpeq_epi8(x, del)));
+
+				width += 32 - popcount(control);
+			}
+
+		#elif defined(BR_SIMD_SSE42)
+			const __m128i space = _mm_set1_epi8(0x20);
+			const __m128i del = _mm_set1_epi8(0x7F);
+
+			for (; end - ptr >= 16; ptr += 16) {
+				const __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+				if (_mm_movemask_epi8(x))
+					break;
+
+				const u32_t control = _mm_movemask_epi8(_mm_or_si128(
+					_mm_cmplt_epi8(x, space),
+					_mm_cmpeq_epi8(x, del)));
+
+				width += 16 - popcount(control);
+			}
+		#endif
+
+			// Adding 0x60 to an ASCII byte sets its high bit if it's
+			// at least a space.
+			for (; end - ptr >= 8; ptr += 8) {
+				const u64_t x = load<u64_t>(ptr);
+
+				if (x & SWAR_HIGH)
+					break;
+
+				const u64_t printable = (x + swar_broadcast(0x60)) & ~swar_eq(x, 0x7F);
+				width += popcount(printable & SWAR_HIGH);
+			}
+
+			return ascii_width(ptr, end, width);
+		}
+	}
+
+	// Total display width of a string. Input must be valid UTF-8.
+	constexpr size_t display_width(str_view sv) {
+		size_t width = 0;
+
+		while (not eof(sv)) {
+			sv.begin = is_constant_evaluated() ?
+				detail::ascii_width(sv.begin, sv.end, width) :
+				detail::ascii_width_wide(sv.begin, sv.end, width);
+
+			if (eof(sv))
+				break;
+
+			char_t c = 0;
+			sv = iter_next_char(sv, c);
+			width += display_width(c);
+		}
+
+		return width;
 	}
 
 }
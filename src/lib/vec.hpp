@@ -7,11 +7,24 @@
 #include <lib/misc.hpp>
 #include <lib/assert.hpp>
 
+// With BR_ALLOC_STATS these pass the caller's line to the site-first
+// overloads below. Without it they are the plain calls.
+#if defined(BR_ALLOC_STATS)
+	#define BR_EMPLACE(...) br::emplace(br::alloc_site::current(), __VA_ARGS__)
+	#define BR_MAKE_VEC(...) br::make_vec(br::alloc_site::current(), __VA_ARGS__)
+#else
+	#define BR_EMPLACE(...) br::emplace(__VA_ARGS__)
+	#define BR_MAKE_VEC(...) br::make_vec(__VA_ARGS__)
+#endif
+
 namespace br {
 
-	template <typename T>
-	struct vec {
+	// The allocator policy is a base so the default, stateless one
+	// takes no space.
+	template <typename T, typename A = heap_allocator>
+	struct vec: A {
 		using type = T;
+		using allocator_type = A;
 
 		T* data = nullptr;
 		size_t capacity = 0;
@@ -20,23 +33,28 @@ namespace br {
 
 
 	// Size and capacity.
-	template <typename T>
-	constexpr size_t length(vec<T> v) {
+	template <typename T, typename A>
+	constexpr size_t length(vec<T, A> v) {
 		return v.used;
 	}
 
-	template <typename T>
-	constexpr size_t capacity(vec<T> v) {
+	template <typename T, typename A>
+	constexpr size_t capacity(vec<T, A> v) {
 		return v.capacity;
 	}
 
 
 	// Access a specific index.
-	template <typename T>
-	constexpr auto data(vec<T>& v, index_t i) {
+	template <typename T, typename A>
+	constexpr auto data(vec<T, A>& v, index_t i) {
 		return v.data + i;
 	}
 
+	template <typename T, typename A>
+	constexpr A& allocator(vec<T, A>& v) {
+		return v;
+	}
+
 
 	namespace detail {
 		constexpr size_t grow_cap(size_t cap) {
@@ -44,83 +62,120 @@ namespace br {
 		}
 
 		// Grow a vector by a growth factor of 1.5.
-		template <typename T>
-		[[nodiscard]] inline vec<T> grow(vec<T> v) {
+		template <typename T, typename A>
+		[[nodiscard]] inline vec<T, A> grow(vec<T, A> v, alloc_site site) {
 			const size_t new_cap = grow_cap(v.capacity); // Increase by 1/2 of capacity
-			v.data = br::alloc<T>(new_cap, v.data);  // Realloc moves memory for us.
+			v.data = allocate(allocator(v), v.data, v.capacity, new_cap, site);  // Allocator moves memory for us.
 			v.capacity = new_cap; // Update capacity.
 			return v;
 		}
 
 		// Allocate initial storage space for vector.
-		template <typename T>
-		[[nodiscard]] inline vec<T> alloc(vec<T> v, size_t count) {
+		template <typename T, typename A>
+		[[nodiscard]] inline vec<T, A> alloc(vec<T, A> v, size_t count, alloc_site site) {
 			const size_t new_cap = max(VEC_MINIMUM_LENGTH, grow_cap(count));
-			v.data = br::alloc<T>(new_cap);
+			v.data = allocate(allocator(v), (T*)nullptr, 0, new_cap, site);
 			v.capacity = new_cap;
 			return v;
 		}
+
+		template <typename T, typename A, typename... Ts>
+		[[nodiscard]] constexpr vec<T, A> emplace(vec<T, A> v, alloc_site site, Ts... args) {
+			if (v.used == v.capacity)
+				v = grow(v, site);
+
+			v.data[v.used] = T { args... };
+			v.used++;
+
+			return v;
+		}
 	}
 
 
 	// In-place construct an element.
-	template <typename T, typename... Ts>
-	[[nodiscard]] constexpr vec<T> emplace(vec<T> v, Ts... args) {
-		if (v.used == v.capacity)
-			v = detail::grow(v);
-
-		v.data[v.used] = T { args... };
-		v.used++;
+	template <typename T, typename A, typename... Ts>
+	[[nodiscard]] constexpr vec<T, A> emplace(vec<T, A> v, Ts... args) {
+		return detail::emplace(v, alloc_site::current(), args...);
+	}
 
-		return v;
+	// As above but recorded by `alloc_stats` against `site`. A pack
+	// can't be followed by a defaulted `alloc_site` so it comes first.
+	// Reached through `BR_EMPLACE`.
+	template <typename T, typename A, typename... Ts>
+	[[nodiscard]] constexpr vec<T, A> emplace(alloc_site site, vec<T, A> v, Ts... args) {
+		return detail::emplace(v, site, args...);
 	}
 
 
 	// Push back an element.
-	template <typename T>
-	[[nodiscard]] constexpr vec<T> push(vec<T> v, T x) {
-		return emplace(v, x);
+	template <typename T, typename A>
+	[[nodiscard]] constexpr vec<T, A> push(vec<T, A> v, T x, alloc_site site = alloc_site::current()) {
+		return detail::emplace(v, site, x);
 	}
 
-	template <typename T>
-	[[nodiscard]] constexpr vec<T> pop(vec<T> v, size_t n = 1) {
+	template <typename T, typename A>
+	[[nodiscard]] constexpr vec<T, A> pop(vec<T, A> v, size_t n = 1) {
 		BR_ASSERT(n > 0);
 		v.used -= n;
 		return v;
 	}
 
 
-	// Increase capacity by N.
-	template <typename T>
-	[[nodiscard]] constexpr vec<T> reserve(vec<T> v, size_t n) {
-		v.capacity += n;
-		v.data = br::alloc<T>(v.capacity, v.data);
+	// Make room for N more elements so the next N pushes don't
+	// allocate. Capacity is left alone if there is room already.
+	// `small_vec` follows the same rule.
+	template <typename T, typename A>
+	[[nodiscard]] constexpr vec<T, A> reserve(vec<T, A> v, size_t n, alloc_site site = alloc_site::current()) {
+		if (v.used + n > v.capacity) {
+			v.data = allocate(allocator(v), v.data, v.capacity, v.used + n, site);
+			v.capacity = v.used + n;
+		}
+
 		return v;
 	}
 
 	// Emplace N new elements.
-	template <typename T>
-	[[nodiscard]] constexpr vec<T> resize(vec<T> v, size_t n) {
+	template <typename T, typename A>
+	[[nodiscard]] constexpr vec<T, A> resize(vec<T, A> v, size_t n, alloc_site site = alloc_site::current()) {
 		while (n--)
-			emplace(v);
+			v = detail::emplace(v, site);
+
+		return v;
 	}
 
 
 	// Make a vector with no elements.
 	template <typename T>
-	[[nodiscard]] constexpr auto make_vec() {
-		return detail::alloc(vec<T>{ nullptr, 0, 0 }, 0); // Minimum length value will be used here.
+	[[nodiscard]] constexpr auto make_vec(alloc_site site = alloc_site::current()) {
+		return detail::alloc(vec<T>{}, 0, site); // Minimum length value will be used here.
+	}
+
+	// Make a vector with no elements which gets its storage from `a`.
+	template <typename T, typename A, typename = enable_if_t<is_allocator_v<A>>>
+	[[nodiscard]] constexpr auto make_vec(A a, alloc_site site = alloc_site::current()) {
+		vec<T, A> v;
+		allocator(v) = a;
+
+		return detail::alloc(v, 0, site);
 	}
 
 
 	// Make a vector with a number of elements.
 	template <typename... Ts>
 	[[nodiscard]] constexpr auto make_vec(Ts... args) {
+		return make_vec(alloc_site::current(), args...);
+	}
+
+	// As above but recorded by `alloc_stats` against `site`.
+	// Reached through `BR_MAKE_VEC`.
+	template <typename... Ts>
+	[[nodiscard]] constexpr auto make_vec(alloc_site site, Ts... args) {
 		using T = first_t<Ts...>;
 		BR_STATIC_ASSERT((equivalence_v<T, Ts...>));
 
 		// Allocate initial buffer.
-		auto v = detail::alloc(vec<T>{ nullptr, 0, sizeof...(Ts) }, sizeof...(Ts));
+		auto v = detail::alloc(vec<T>{}, sizeof...(Ts), site);
+		v.used = sizeof...(Ts);
 
 		// Push back elements.
 		index_t i = 0;
@@ -131,9 +186,10 @@ namespace br {
 
 
 	// Destroy a vector and release its memory.
-	template <typename T>
-	[[nodiscard]] constexpr vec<T> destroy_vec(vec<T> v) {
-		free(v.data);
+	// Not needed for vectors in an arena.
+	template <typename T, typename A>
+	[[nodiscard]] constexpr vec<T, A> destroy_vec(vec<T, A> v) {
+		deallocate(allocator(v), v.data, v.capacity);
 		v.data = nullptr;
 		return v;
 	}
@@ -24,7 +24,7 @@ while IFS="
 	fname="$(basename "$file" .cpp)"
 
 	# lookup basename of current test in tests
-	expected=$(echo "$test_cases" | awk "/$fname/ { print \$2 }")
+	expected=$(echo "$test_cases" | awk -v f="$fname.cpp" '$1 == f { print $2 }')
 
 	[ -z "$expected" ] && die "$fname not found in test cases file"
 
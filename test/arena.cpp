@@ -0,0 +1,75 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/mem.hpp>
+
+int main(int argc, const char* argv[]) {
+	auto a = br::make_arena(1024);
+	const auto empty = br::mark_arena(a);
+	const auto initial = br::memory_footprint(a);
+
+	// Small allocations are consecutive and suitably aligned.
+	char* c;
+	br::u64_t* x;
+	br::u64_t* y;
+
+	a = br::arena_alloc(a, 3, c);
+	a = br::arena_alloc(a, 1, x);
+	a = br::arena_alloc(a, 1, y);
+
+	BR_ASSERT((br::ptr_t)x % alignof(br::u64_t) == 0);
+	BR_ASSERT(y == x + 1);
+
+	*x = 1;
+	*y = 2;
+
+	char* wide;
+	a = br::arena_alloc(a, 10, wide, 64);
+	BR_ASSERT((br::ptr_t)wide % 64 == 0);
+
+	// Allocations that don't fit in a chunk start new ones without
+	// disturbing earlier ones.
+	const auto mark = br::mark_arena(a);
+
+	for (br::index_t i = 0; i != 1000; ++i) {
+		br::u32_t* p;
+		a = br::arena_alloc(a, 10, p);
+
+		for (br::index_t j = 0; j != 10; ++j)
+			p[j] = i;
+	}
+
+	BR_ASSERT(*x == 1 and *y == 2);
+	BR_ASSERT(br::memory_footprint(a) > initial);
+
+	// A large request gets a chunk of its own and the current chunk
+	// keeps being used afterwards.
+	const auto before = br::mark_arena(a);
+
+	char* big;
+	a = br::arena_alloc(a, 1 << 20, big);
+	br::fill(big, 1 << 20, 'x');
+
+	char* next;
+	a = br::arena_alloc(a, 1, next);
+	BR_ASSERT(next == before.head);
+
+	// Rewinding releases the chunks allocated since the mark and
+	// continues from where it was taken.
+	a = br::rewind_arena(a, mark);
+
+	br::u64_t* z;
+	a = br::arena_alloc(a, 1, z);
+	BR_ASSERT((char*)z >= mark.head and (char*)z < mark.tail);
+
+	a = br::rewind_arena(a, empty);
+	BR_ASSERT(br::memory_footprint(a) == initial);
+
+	a = br::arena_alloc(a, 3, c);
+	BR_ASSERT(c == empty.head);
+
+	a = br::destroy_arena(a);
+	BR_ASSERT(br::memory_footprint(a) == 0);
+
+	return br::EXIT_SUCCESS;
+}
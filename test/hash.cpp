@@ -0,0 +1,41 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/str.hpp>
+#include <lib/hash.hpp>
+
+// Literals are hashed at compile time with the same function.
+static_assert("section"_h == br::hash(cstr("section")));
+static_assert("section"_h != "subsection"_h);
+
+int main(int argc, const char* argv[]) {
+	// Reference vectors from wyhash (seed = index).
+	br::str_view inputs[] = {
+		cstr(""),
+		cstr("a"),
+		cstr("abc"),
+		cstr("message digest"),
+		cstr("abcdefghijklmnopqrstuvwxyz"),
+		cstr("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"),
+		cstr("12345678901234567890123456789012345678901234567890123456789012345678901234567890"),
+	};
+
+	br::u64_t expected[] = {
+		0x93228a4de0eec5a2ull,
+		0xc5bac3db178713c4ull,
+		0xa97f2f7b1d9b3314ull,
+		0x786d1f1df3801df4ull,
+		0xdca5a8138ad37c87ull,
+		0xb9e734f117cfaf70ull,
+		0x6cc5eab49a92d617ull,
+	};
+
+	for (br::index_t i = 0; i != br::length(inputs); ++i)
+		BR_ASSERT(br::hash(inputs[i], i) == expected[i]);
+
+	// Runtime strings agree with literals.
+	char buf[] = "section";
+	BR_ASSERT(br::hash(br::make_sv(buf, br::length(buf) - 1)) == "section"_h);
+
+	return br::EXIT_SUCCESS;
+}
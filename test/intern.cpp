@@ -0,0 +1,48 @@
+#include <cstdio>
+
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/str.hpp>
+#include <lib/intern.hpp>
+
+int main(int argc, const char* argv[]) {
+	auto in = br::make_interner();
+
+	br::str_view builtins[] = { cstr("section"), cstr("emph"), cstr("begin"), cstr("end") };
+	br::symbol_t ids[br::length(builtins)];
+
+	in = br::intern(in, builtins, ids);
+
+	BR_ASSERT(br::length(in) == 4);
+	BR_ASSERT(br::find_symbol(in, cstr("emph")) == ids[1]);
+	BR_ASSERT(br::find_symbol(in, cstr("emphasis")) == br::NO_SYMBOL);
+
+	// Interning the same bytes from a different buffer gives the same symbol.
+	char buf[] = "begin";
+	br::symbol_t id;
+
+	in = br::intern(in, br::make_sv(buf, br::length(buf) - 1), id);
+	BR_ASSERT(id == ids[2]);
+	BR_ASSERT(br::symbol_name(in, id).begin != buf);
+	BR_ASSERT(br::length(in) == 4);
+
+	// Force the table to grow and the arena to allocate more blocks.
+	for (br::index_t i = 0; i != 10000; ++i) {
+		char name[16];
+		auto n = std::snprintf(name, sizeof(name), "sym%lu", (unsigned long)i);
+
+		in = br::intern(in, br::make_sv(name, n), id);
+		BR_ASSERT(id == i + 4);
+	}
+
+	for (br::index_t i = 0; i != br::length(builtins); ++i)
+		BR_ASSERT(br::eq(br::symbol_name(in, ids[i]), builtins[i]));
+
+	BR_ASSERT(br::eq(br::symbol_name(in, br::find_symbol(in, cstr("sym9999"))), cstr("sym9999")));
+	BR_ASSERT(br::memory_footprint(in) > 10000 * sizeof(br::str_view));
+
+	in = br::destroy_interner(in);
+
+	return br::EXIT_SUCCESS;
+}
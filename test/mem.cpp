@@ -0,0 +1,73 @@
+#include <cstring>
+
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/mem.hpp>
+
+// Compare against libc for every size up to a few vectors and every
+// alignment within a vector, including overlapping moves both ways.
+int main(int argc, const char* argv[]) {
+	constexpr br::size_t N = 512;
+
+	char src[N];
+	char expected[N];
+	char actual[N];
+
+	for (br::index_t i = 0; i != N; ++i)
+		src[i] = (char)(i * 7 + 1);
+
+	for (br::size_t n = 0; n != 300; ++n) {
+		for (br::size_t from = 0; from != 33; ++from) {
+			for (br::size_t to = 0; to != 33; to += 3) {
+				std::memcpy(expected, src, N);
+				std::memcpy(actual, src, N);
+
+				std::memcpy(expected + to + 100, src + from, n);
+				br::memcpy(src + from, actual + to + 100, n);
+				BR_ASSERT(std::memcmp(expected, actual, N) == 0);
+
+				// Overlapping, in both directions.
+				std::memmove(expected + to, expected + from, n);
+				br::memmove(actual + from, actual + to, n);
+				BR_ASSERT(std::memcmp(expected, actual, N) == 0);
+
+				std::memmove(expected + from + 40, expected + to + 50, n);
+				br::memmove(actual + to + 50, actual + from + 40, n);
+				BR_ASSERT(std::memcmp(expected, actual, N) == 0);
+
+				char* const ptr = actual + from;
+				std::memset(expected + from, (int)(n + to), n);
+				br::fill(ptr, n, (char)(n + to));
+				BR_ASSERT(std::memcmp(expected, actual, N) == 0);
+			}
+		}
+	}
+
+	// Wider values are still filled element by element.
+	br::u32_t words[37];
+	br::fill(words, 37, 0xDEADBEEFu);
+
+	for (auto x: words)
+		BR_ASSERT(x == 0xDEADBEEFu);
+
+	// Large blocks grow in place until they outgrow their reservation
+	// and keep their contents when they move.
+	char* big = br::map_alloc<char>(100);
+	br::fill(big, 100, 'a');
+
+	char* const first = big;
+	big = br::map_alloc(br::MAP_RESERVE_LENGTH / 2, big);
+	BR_ASSERT(big == first);
+
+	big[br::MAP_RESERVE_LENGTH / 2 - 1] = 'b';
+	big = br::map_alloc(br::MAP_RESERVE_LENGTH * 2, big);
+
+	BR_ASSERT(big[0] == 'a' and big[99] == 'a');
+	BR_ASSERT(big[br::MAP_RESERVE_LENGTH / 2 - 1] == 'b');
+
+	big[br::MAP_RESERVE_LENGTH * 2 - 1] = 'c';
+	br::map_free(big);
+
+	return br::EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include <thread>
+
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/pool.hpp>
+
+struct node {
+	node* next;
+	br::u64_t value;
+	br::u32_t owner;
+};
+
+int main(int argc, const char* argv[]) {
+	auto p = br::make_pool<node>(4096);
+
+	// Single thread: freed objects are reused before new ones are carved.
+	{
+		br::pool_cache<node> c;
+
+		node* a = br::pool_alloc(p, c);
+		node* b = br::pool_alloc(p, c);
+
+		BR_ASSERT(a != b);
+		BR_ASSERT((br::ptr_t)a % alignof(node) == 0);
+
+		br::pool_free(p, c, a);
+		BR_ASSERT(br::pool_alloc(p, c) == a);
+
+		br::pool_free(p, c, a);
+		br::pool_free(p, c, b);
+		br::pool_free(p, c, (node*)nullptr);
+
+		br::drain_pool_cache(p, c);
+		BR_ASSERT(c.count == 0);
+
+		const auto s = br::stats(p);
+		BR_ASSERT(s.allocs == 3 and s.frees == 3);
+		BR_ASSERT(s.hits == 2 and s.refills == 1);
+		BR_ASSERT(s.slabs == 1);
+	}
+
+	// Several threads each build and tear down lists, handing some
+	// nodes to the next thread to free so objects cross caches.
+	constexpr br::size_t threads = 4;
+	constexpr br::size_t rounds = 200;
+	constexpr br::size_t length = 500;
+
+	node* handoff[threads] = {};
+
+	const auto work = [&] (br::u32_t id) {
+		br::pool_cache<node> c;
+
+		for (br::index_t r = 0; r != rounds; ++r) {
+			node* list = nullptr;
+
+			for (br::index_t i = 0; i != length; ++i) {
+				node* n = br::pool_alloc(p, c);
+				*n = { list, i, id };
+				list = n;
+			}
+
+			for (br::index_t i = length; list; --i) {
+				BR_ASSERT(list->value == i - 1 and list->owner == id);
+
+				node* next = list->next;
+				br::pool_free(p, c, list);
+				list = next;
+			}
+		}
+
+		node* n = br::pool_alloc(p, c);
+		*n = { nullptr, 0, id };
+		handoff[id] = n;
+
+		br::drain_pool_cache(p, c);
+	};
+
+	std::thread ts[threads];
+
+	for (br::u32_t i = 0; i != threads; ++i)
+		ts[i] = std::thread(work, i);
+
+	for (auto& t: ts)
+		t.join();
+
+	{
+		br::pool_cache<node> c;
+
+		for (br::u32_t i = 0; i != threads; ++i) {
+			BR_ASSERT(handoff[i]->owner == i);
+			br::pool_free(p, c, handoff[i]);
+		}
+
+		br::drain_pool_cache(p, c);
+	}
+
+	const auto s = br::stats(p);
+	const br::size_t expected = 3 + threads * (rounds * length + 1);
+
+	BR_ASSERT(s.allocs == expected and s.frees == expected);
+	BR_ASSERT(s.hits > s.allocs - s.refills * br::POOL_CACHE_LENGTH);
+	BR_ASSERT(br::memory_footprint(p) < threads * length * 4 * sizeof(node));
+
+	p = br::destroy_pool(p);
+
+	return br::EXIT_SUCCESS;
+}
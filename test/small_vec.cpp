@@ -0,0 +1,93 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/small_vec.hpp>
+
+int main(int argc, const char* argv[]) {
+	// Stays inline up to N elements.
+	auto v = br::make_small_vec<br::u32_t, 8>();
+
+	for (br::u32_t i = 0; i != 8; ++i)
+		v = br::push(v, i * 3);
+
+	BR_ASSERT(br::length(v) == 8 and br::capacity(v) == 8);
+	BR_ASSERT(not br::spilled(v));
+
+	// Copies are independent while inline.
+	auto copy = v;
+	copy = br::pop(copy);
+	*br::data(copy, 0) = 100;
+
+	BR_ASSERT(br::at(v, 0) == 0 and br::length(v) == 8);
+
+	// Spills to the heap keeping its contents.
+	for (br::u32_t i = 8; i != 1000; ++i)
+		v = br::push(v, i * 3);
+
+	BR_ASSERT(br::spilled(v) and br::length(v) == 1000);
+
+	for (br::index_t i = 0; i != 1000; ++i)
+		BR_ASSERT(br::at(v, i) == i * 3);
+
+	BR_ASSERT(br::front(v) == 0 and br::back(v) == 999 * 3);
+
+	v = br::pop(v, 990);
+	BR_ASSERT(br::length(v) == 10 and br::back(v) == 27);
+
+	v = br::destroy_small_vec(v);
+	BR_ASSERT(br::length(v) == 0 and not br::spilled(v));
+
+	// Made from elements, with more than fit inline.
+	auto w = br::make_small_vec<2>(1, 2, 3, 4);
+	BR_ASSERT(br::length(w) == 4 and br::spilled(w));
+	BR_ASSERT(br::at(w, 3) == 4);
+	w = br::destroy_small_vec(w);
+
+	auto x = br::make_small_vec<4>(1, 2);
+	BR_ASSERT(br::length(x) == 2 and not br::spilled(x));
+
+	// Reserving what already fits stays inline.
+	x = br::reserve(x, 0);
+	x = br::reserve(x, 2);
+	BR_ASSERT(br::capacity(x) == 4 and not br::spilled(x));
+
+	x = br::reserve(x, 10);
+	BR_ASSERT(br::capacity(x) == 12 and br::spilled(x) and br::at(x, 1) == 2);
+	x = br::destroy_small_vec(x);
+
+	// Spills into an arena.
+	{
+		auto a = br::make_arena();
+
+		auto y = br::make_small_vec<br::u32_t, 4>(br::arena_allocator { &a });
+
+		for (br::u32_t i = 0; i != 100; ++i)
+			y = br::push(y, i);
+
+		BR_ASSERT(br::spilled(y) and br::length(y) == 100);
+
+		for (br::index_t i = 0; i != 100; ++i)
+			BR_ASSERT(br::at(y, i) == i);
+
+		y = br::destroy_small_vec(y);
+		a = br::destroy_arena(a);
+	}
+
+	// Any number of constructor arguments.
+	{
+		struct point { br::u32_t x, y, z, w, t; };
+
+		auto p = br::make_small_vec<point, 1>();
+		p = br::emplace(p, 1u, 2u, 3u, 4u, 5u);
+		p = BR_EMPLACE(p, 6u, 7u, 8u, 9u, 10u);
+
+		BR_ASSERT(br::spilled(p) and br::data(p, 1)->t == 10);
+		p = br::destroy_small_vec(p);
+
+		auto q = BR_MAKE_SMALL_VEC(2, 1, 2, 3);
+		BR_ASSERT(br::length(q) == 3 and br::at(q, 2) == 3);
+		q = br::destroy_small_vec(q);
+	}
+
+	return br::EXIT_SUCCESS;
+}
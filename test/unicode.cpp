@@ -0,0 +1,216 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/str.hpp>
+#include <lib/unicode.hpp>
+
+static_assert(br::category('A') == br::CATEGORY_LU);
+static_assert(br::is_letter(U'Γ'));
+
+int main(int argc, const char* argv[]) {
+	BR_ASSERT(br::category('a') == br::CATEGORY_LL);
+	BR_ASSERT(br::category('0') == br::CATEGORY_ND);
+	BR_ASSERT(br::category(' ') == br::CATEGORY_ZS);
+	BR_ASSERT(br::category('\n') == br::CATEGORY_CC);
+	BR_ASSERT(br::category(0x20AC) == br::CATEGORY_SC);  // €
+	BR_ASSERT(br::category(0x1F600) == br::CATEGORY_SO); // 😀
+	BR_ASSERT(br::category(0x0301) == br::CATEGORY_MN);  // Combining acute.
+
+	// Inside ranges given only by their endpoints in UnicodeData.txt.
+	BR_ASSERT(br::category(0x4E2D) == br::CATEGORY_LO);  // 中
+	BR_ASSERT(br::category(0xAC01) == br::CATEGORY_LO);  // Hangul syllable.
+	BR_ASSERT(br::category(0xD900) == br::CATEGORY_CS);
+	BR_ASSERT(br::category(0xE123) == br::CATEGORY_CO);
+
+	// Unassigned and out of range.
+	BR_ASSERT(br::category(0x0378) == br::CATEGORY_CN);
+	BR_ASSERT(br::category(0x10FFFF) == br::CATEGORY_CN);
+	BR_ASSERT(br::category(0x110000) == br::CATEGORY_CN);
+
+	BR_ASSERT(br::is_punctuation('{'));
+	BR_ASSERT(br::is_symbol('+'));
+	BR_ASSERT(br::is_whitespace('\t'));
+	BR_ASSERT(not br::is_visible(' '));
+	BR_ASSERT(br::is_alphanumeric(0x0662));  // Arabic-Indic two.
+	BR_ASSERT(br::is_seperator(0x2028));     // Line separator.
+	BR_ASSERT(not br::is_whitespace(0x2028));
+	BR_ASSERT(br::is_other(0xE000));
+	BR_ASSERT(br::properties(0xE000) == 0);
+
+	// Property bits agree with categories.
+	for (br::char_t c = 0; c != 0x30000; ++c) {
+		BR_ASSERT(br::is_letter(c) == (br::is_lu(c) or br::is_ll(c) or br::is_lt(c) or br::is_lm(c) or br::is_lo(c)));
+		BR_ASSERT(br::is_whitespace(c) == (br::is_zs(c) or br::is_cc(c) or br::is_cf(c)));
+		BR_ASSERT(br::is_seperator(c) == (br::is_zs(c) or br::is_zl(c) or br::is_zp(c)));
+	}
+
+	// Identifiers.
+	BR_ASSERT(br::is_xid_start('a') and br::is_xid_start(U'Γ') and br::is_xid_start(0x4E2D));
+	BR_ASSERT(not br::is_xid_start('_') and not br::is_xid_start('1') and not br::is_xid_start(0x0301));
+	BR_ASSERT(br::is_xid_continue('_') and br::is_xid_continue('1') and br::is_xid_continue(0x0301));
+	BR_ASSERT(br::is_xid_continue(0x00B7));                                 // Other_ID_Continue.
+	BR_ASSERT(br::is_xid_start(0x2118));                                    // Other_ID_Start.
+	BR_ASSERT(not br::is_xid_start(0x2E2F) and not br::is_xid_continue(0x2E2F)); // Pattern_Syntax.
+	BR_ASSERT(not br::is_xid_start(0x037A) and not br::is_xid_continue(0x037A)); // Not closed under NFKC.
+	BR_ASSERT(not br::is_xid_start(0xFF9E) and br::is_xid_continue(0xFF9E));
+	BR_ASSERT(not br::is_xid_continue(' ') and not br::is_xid_continue(0x110000));
+
+	// Case mapping.
+	BR_ASSERT(br::to_lower('A') == 'a' and br::to_lower('[') == '[' and br::to_upper('z') == 'Z');
+	BR_ASSERT(br::to_lower(U'Γ') == U'γ' and br::to_upper(U'ς') == U'Σ');
+	BR_ASSERT(br::fold_case(U'ς') == U'σ' and br::fold_case(0x212A) == 'k'); // KELVIN SIGN.
+	BR_ASSERT(br::fold_case(0xAB70) == 0x13A0);                           // Cherokee folds to upper.
+	BR_ASSERT(br::fold_case(0x0131) == 0x0131);                           // Dotless i.
+
+	{
+		auto lower = br::to_lower(cstr("\\Section{ΓΑΖΈΕΣ Ⱥ} 0123456789ABCDEF0123456789ABCDEF"));
+		BR_ASSERT(br::eq(br::make_sv(lower.data, br::length(lower)), cstr("\\section{γαζέεσ ⱥ} 0123456789abcdef0123456789abcdef")));
+		lower = br::destroy_vec(lower);
+
+		auto upper = br::to_upper(cstr("straße"));
+		BR_ASSERT(br::eq(br::make_sv(upper.data, br::length(upper)), cstr("STRAßE")));
+		upper = br::destroy_vec(upper);
+
+		BR_ASSERT(br::eq_fold(cstr("\\BeginDocument"), cstr("\\begindocument")));
+		BR_ASSERT(br::eq_fold(cstr("0123456789abcdef0123456789ABCDEF Kelvin"), cstr("0123456789ABCDEF0123456789abcdef \xe2\x84\xaa" "elvin")));
+		BR_ASSERT(br::eq_fold(cstr("Σίσυφος"), cstr("ΣΊΣΥΦΟΣ")));
+		BR_ASSERT(not br::eq_fold(cstr("abc"), cstr("abd")));
+		BR_ASSERT(not br::eq_fold(cstr("abc"), cstr("ab")));
+		BR_ASSERT(not br::eq_fold(cstr("@"), cstr("`")));
+	}
+
+	// Normalization.
+	BR_ASSERT(br::combining_class('a') == 0 and br::combining_class(0x0301) == 230);
+	BR_ASSERT(br::nfc_quick_check(0x0301) == br::QUICK_CHECK_MAYBE);
+	BR_ASSERT(br::nfc_quick_check(0x212B) == br::QUICK_CHECK_NO);      // ANGSTROM SIGN.
+	BR_ASSERT(br::nfc_quick_check(0x0958) == br::QUICK_CHECK_NO);      // Composition exclusion.
+
+	{
+		auto v = br::make_vec<char>();
+		br::str_view out;
+
+		// Already normalized text is returned as is.
+		auto text = cstr("\\section{Γαζέες} café 한국어 0123456789abcdef0123456789abcdef");
+		v = br::nfc(text, v, out);
+		BR_ASSERT(out.begin == text.begin and out.end == text.end and br::length(v) == 0);
+		BR_ASSERT(br::nfc_quick_check(text) == br::QUICK_CHECK_YES and br::is_nfc(text));
+
+		// Maybe, but nothing composes.
+		text = cstr("x\xcc\x81");
+		v = br::nfc(text, v, out);
+		BR_ASSERT(out.begin == text.begin and br::length(v) == 0);
+		BR_ASSERT(br::nfc_quick_check(text) == br::QUICK_CHECK_MAYBE and br::is_nfc(text));
+
+		// Only the decomposed runs are rewritten.
+		text = cstr("0123456789abcdef0123456789abcdef \\cafe\xcc\x81 and A\xcc\x8a \xe2\x84\xab!");
+		v = br::nfc(text, v, out);
+		BR_ASSERT(br::eq(out, cstr("0123456789abcdef0123456789abcdef \\café and Å Å!")));
+		BR_ASSERT(not br::is_nfc(text));
+
+		// Combining marks are reordered before composing.
+		v.used = 0;
+		v = br::nfc(cstr("a\xcc\xa3\xcc\x82 a\xcc\x82\xcc\xa3 \xe1\xba\xa1\xcc\x82"), v, out);
+		BR_ASSERT(br::eq(out, cstr("ậ ậ ậ")));
+
+		// Hangul jamo compose arithmetically.
+		v.used = 0;
+		v = br::nfc(cstr("\xe1\x84\x92\xe1\x85\xa1\xe1\x86\xab"), v, out);
+		BR_ASSERT(br::eq(out, cstr("한")));
+
+		v = br::destroy_vec(v);
+	}
+
+	// Into an arena.
+	{
+		auto a = br::make_arena();
+
+		auto v = br::make_vec<char>(br::arena_allocator { &a });
+		br::str_view out;
+
+		v = br::nfc(cstr("\\cafe\xcc\x81 A\xcc\x8a \xe1\x84\x92\xe1\x85\xa1\xe1\x86\xab"), v, out);
+		BR_ASSERT(br::eq(out, cstr("\\café Å 한")));
+
+		a = br::destroy_arena(a);
+	}
+
+	// Grapheme clusters.
+	BR_ASSERT(br::grapheme_break('\r') == br::GRAPHEME_BREAK_CR);
+	BR_ASSERT(br::grapheme_break(0x0301) == br::GRAPHEME_BREAK_EXTEND);
+	BR_ASSERT(br::grapheme_break(0x1F600) == br::GRAPHEME_BREAK_PICTOGRAPHIC);
+	BR_ASSERT(br::grapheme_break(0xAC00) == br::GRAPHEME_BREAK_LV and br::grapheme_break(0xAC01) == br::GRAPHEME_BREAK_LVT);
+
+	{
+		br::str_view expected[] = {
+			cstr("a"),
+			cstr("e\xcc\x81"),                        // Combining acute.
+			cstr("\r\n"),
+			cstr("🇬🇧"),
+			cstr("🇫🇷"),
+			cstr("👩‍👩‍👧"),                             // ZWJ sequence.
+			cstr("👍🏽"),                              // Skin tone modifier.
+			cstr("\xe1\x84\x92\xe1\x85\xa1\xe1\x86\xab"), // Hangul jamo.
+			cstr("कि"),                               // Spacing mark.
+			cstr("\n"),
+			cstr("\xcc\x81"),                         // Mark after a control.
+			cstr("z"),
+		};
+
+		br::str_view text = cstr("ae\xcc\x81\r\n🇬🇧🇫🇷👩‍👩‍👧👍🏽\xe1\x84\x92\xe1\x85\xa1\xe1\x86\xabकि\n\xcc\x81z");
+		br::str_view cluster;
+		br::index_t i = 0;
+
+		BR_ASSERT(br::grapheme_length(text) == br::length(expected));
+
+		for (auto it = text; not br::eof(it); ++i) {
+			it = br::iter_next_grapheme(it, cluster);
+			BR_ASSERT(br::eq(cluster, expected[i]));
+		}
+
+		BR_ASSERT(i == br::length(expected));
+
+		BR_ASSERT(br::grapheme_length(cstr("")) == 0);
+		BR_ASSERT(br::grapheme_length(cstr("0123456789abcdef\r\n0123456789abcdef\r\n")) == 34);
+		BR_ASSERT(br::grapheme_length(cstr("0123456789abcdef0123456789abcdefe\xcc\x81")) == 33);
+		BR_ASSERT(br::grapheme_length(cstr("🇬🇧🇫")) == 2);
+	}
+
+	// Display width.
+	BR_ASSERT(br::display_width('a') == 1 and br::display_width('\t') == 0 and br::display_width(0x7F) == 0);
+	BR_ASSERT(br::display_width(0x4E2D) == 2 and br::display_width(0xFF21) == 2);  // 中, fullwidth A.
+	BR_ASSERT(br::display_width(0x1F600) == 2 and br::display_width(0x20000) == 2);
+	BR_ASSERT(br::display_width(0x0301) == 0 and br::display_width(0x200B) == 0);  // Combining acute, zero width space.
+	BR_ASSERT(br::display_width(0x11A8) == 0);                                      // Conjoining jamo.
+	BR_ASSERT(br::display_width(U'Γ') == 1 and br::display_width(0x110000) == 1);
+
+	BR_ASSERT(br::display_width(cstr("")) == 0);
+	BR_ASSERT(br::display_width(cstr("中文 abc")) == 8);
+	BR_ASSERT(br::display_width(cstr("e\xcc\x81\t0123456789abcdef0123456789abcdef\x7f" "0123456789abcdef😀")) == 1 + 32 + 16 + 2);
+
+	// Bulk classification.
+	{
+		auto text = cstr("\\emph{Γαζέες} and 0123456789abcdef0123456789abcdef0123456789abcdef x");
+		br::property_t props[128];
+
+		const auto n = br::classify(text, props);
+		BR_ASSERT(n == br::utf_length(text));
+
+		br::index_t i = 0;
+
+		for (auto it = text; not br::eof(it); it = br::next_char(it))
+			BR_ASSERT(props[i++] == br::properties(br::as_char(it)));
+
+		auto rest = br::span_while(br::next_byte(text), br::PROPERTY_LETTER);
+		BR_ASSERT(br::eq(rest, cstr("{Γαζέες} and 0123456789abcdef0123456789abcdef0123456789abcdef x")));
+
+		rest = br::span_while(br::next_byte(rest), br::PROPERTY_LETTER);
+		BR_ASSERT(br::eq(rest, cstr("} and 0123456789abcdef0123456789abcdef0123456789abcdef x")));
+
+		rest = br::span_while(br::find_byte(rest, '0'), br::PROPERTY_ALPHANUMERIC);
+		BR_ASSERT(br::eq(rest, cstr(" x")));
+
+		rest = br::span_while(rest, br::PROPERTY_WHITESPACE);
+		BR_ASSERT(br::eq(rest, cstr("x")));
+	}
+
+	return br::EXIT_SUCCESS;
+}
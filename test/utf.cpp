@@ -3,15 +3,47 @@
 
 #include <lib/def.hpp>
 #include <lib/exit.hpp>
-#include <lib/io.hpp>
 #include <lib/assert.hpp>
-#include <lib/log.hpp>
 #include <lib/str.hpp>
 
 // https://unicodemap.org/
 int main(int argc, const char* argv[]) {
 	BR_ASSERT(br::eq(cstr("abc"), cstr("abc")) == true);
 	BR_ASSERT(br::eq(cstr("abc"), cstr("abd")) == false);
+	BR_ASSERT(br::eq(cstr("0123456789abcdef0123456789abcdef!"), cstr("0123456789abcdef0123456789abcdef?")) == false);
+
+	BR_ASSERT(br::compare(cstr("abc"), cstr("abc")) == 0);
+	BR_ASSERT(br::compare(cstr("abc"), cstr("abd")) < 0);
+	BR_ASSERT(br::compare(cstr("abcd"), cstr("abc")) > 0);
+	BR_ASSERT(br::compare(cstr("0123456789abcdef\xff"), cstr("0123456789abcdef0")) > 0);
+
+	BR_ASSERT(br::starts_with(cstr("\\macro{arg}"), cstr("\\macro")));
+	BR_ASSERT(not br::starts_with(cstr("\\mac"), cstr("\\macro")));
+	BR_ASSERT(br::ends_with(cstr("\\macro{arg}"), cstr("{arg}")));
+	BR_ASSERT(not br::ends_with(cstr("\\macro{arg}"), cstr("{arf}")));
+
+	// Searching.
+	{
+		auto src = cstr("some text with a \\macro{arg} in it and a %comment at the end\n");
+
+		BR_ASSERT(br::eq(br::find(src, cstr("\\macro")), cstr("\\macro{arg} in it and a %comment at the end\n")));
+		BR_ASSERT(br::eof(br::find(src, cstr("\\micro"))));
+		BR_ASSERT(br::eq(br::find_byte(src, '%'), cstr("%comment at the end\n")));
+		BR_ASSERT(br::eq(br::find_any(src, cstr("\\{}%\n")), cstr("\\macro{arg} in it and a %comment at the end\n")));
+		BR_ASSERT(br::eq(br::rfind(src, cstr("the")), cstr("the end\n")));
+		BR_ASSERT(br::eq(br::rfind_byte(src, 'a'), cstr("at the end\n")));
+
+		br::str_view expected[] = { cstr("a"), cstr("bc"), cstr("") };
+		br::str_view piece;
+		br::index_t i = 0;
+
+		for (auto it = cstr("a, bc, "); not br::is_null(it);) {
+			it = br::iter_split(it, cstr(", "), piece);
+			BR_ASSERT(br::eq(piece, expected[i++]));
+		}
+
+		BR_ASSERT(i == 3);
+	}
 
 	auto str = cstr("Γαζέες");
 	auto invalid = cstr("abcd\x80");
@@ -21,6 +53,149 @@ int main(int argc, const char* argv[]) {
 	BR_ASSERT(br::utf_validate(invalid) == false);
 	BR_ASSERT(br::length(str) == 12);
 
+	// Vectorised validation must agree with the DFA, including
+	// across 64 byte block boundaries.
+	{
+		br::str_view cases[] = {
+			cstr("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdeΓ"),
+			cstr("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\x80"),
+			cstr("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcd\xe2\x82\xac"),
+			cstr("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcde\xe2\x82"),
+			cstr("\xc0\xaf"),          // Overlong.
+			cstr("\xed\xa0\x80"),      // Surrogate.
+			cstr("\xf4\x90\x80\x80"),  // Too large.
+			cstr("\xf0\x9f\x98\x80"),
+			cstr("\xf0\x9f\x98"),      // Truncated.
+			cstr("\xff"),
+			cstr(""),
+		};
+
+		for (auto sv: cases)
+			BR_ASSERT(br::utf_validate(sv) == br::utf_validate_dfa(sv));
+	}
+
+	// Vectorised codepoint counting must agree with iteration.
+	{
+		auto long_str = cstr("Γαζέες abc € 😀 0123456789abcdef0123456789abcdef Γαζέες abc € 😀 0123456789abcdef");
+		br::size_t count = 0;
+
+		for (auto it = long_str; not br::eof(it); it = br::next_char(it))
+			count++;
+
+		BR_ASSERT(br::utf_length(long_str) == count);
+		BR_ASSERT(br::utf_length_prefix(long_str, 0) == 0);
+		BR_ASSERT(br::utf_length_prefix(long_str, 4) == 2);
+		BR_ASSERT(br::utf_length_prefix(long_str, br::length(long_str)) == count);
+	}
+
+	// ASCII runs are split off in bulk.
+	{
+		auto mixed = cstr("\\macro{0123456789abcdef0123456789abcdef}Γα z");
+		br::str_view run;
+
+		auto it = br::next_ascii_run(mixed, run);
+		BR_ASSERT(br::length(run) == 40);
+		BR_ASSERT(br::as_char(it) == 915);
+
+		it = br::next_ascii_run(it, run);
+		BR_ASSERT(br::eof(run));
+
+		br::char_t c;
+		it = br::iter_next_char(it, c);
+		it = br::iter_next_char(it, c);
+		BR_ASSERT(c == 945);
+
+		it = br::next_ascii_run(it, run);
+		BR_ASSERT(br::eq(run, cstr(" z")));
+		BR_ASSERT(br::eof(it));
+	}
+
+	// Bulk decode and encode round trip.
+	{
+		auto text = cstr("0123456789abcdef Γαζέες € 😀 0123456789abcdef0123456789abcdef");
+
+		auto cps = br::utf_decode(text, br::make_vec<br::char_t>());
+		BR_ASSERT(br::length(cps) == br::utf_length(text));
+		BR_ASSERT(br::at(cps, 17) == 915);
+
+		auto bytes = br::utf_encode(cps, br::make_vec<char>());
+		BR_ASSERT(br::eq(br::make_sv(bytes.data, br::length(bytes)), text));
+
+		cps = br::destroy_vec(cps);
+		bytes = br::destroy_vec(bytes);
+	}
+
+	// Long runs of multibyte text go through the shuffles.
+	{
+		constexpr br::str_view texts[] = {
+			cstr("Voix ambiguë d'un cœur qui, au zéphyr, préfère les jattes de kiwis."),
+			cstr("Съешь же ещё этих мягких французских булок, да выпей чаю."),
+			cstr("我能吞下玻璃而不伤身体。日本語の文章、カタカナとひらがな。"),
+			cstr("Party 😀🎉 at 8pm, bring 🍕 and 🍺 please 👍🏽 \xdf\xbf\xe0\xa0\x80\xef\xbf\xbf\xf0\x90\x80\x80 "),  // Ends with U+7FF, U+800, U+FFFF and U+10000.
+		};
+
+		for (auto text: texts) {
+			auto cps = br::utf_decode(text, br::make_vec<br::char_t>());
+			BR_ASSERT(br::length(cps) == br::utf_length(text));
+
+			br::index_t i = 0;
+
+			for (auto it = text; not br::eof(it); ++i) {
+				br::char_t c;
+				it = br::iter_next_char(it, c);
+				BR_ASSERT(br::at(cps, i) == c);
+			}
+
+			auto bytes = br::utf_encode(cps, br::make_vec<char>());
+			BR_ASSERT(br::eq(br::make_sv(bytes.data, br::length(bytes)), text));
+
+			cps = br::destroy_vec(cps);
+			bytes = br::destroy_vec(bytes);
+		}
+	}
+
+	// Indexed random access agrees with linear access.
+	{
+		auto text = cstr("0123456789abcdef Γαζέες € 😀 0123456789abcdef0123456789abcdef Γαζέες € 😀");
+		auto idx = br::make_utf_index(text, 4);
+
+		BR_ASSERT(br::utf_length(idx) == br::utf_length(text));
+
+		for (br::index_t i = 0; i != br::utf_length(text); i++) {
+			BR_ASSERT(br::char_at(idx, i) == br::char_at(text, i));
+			BR_ASSERT(br::eq(br::view_at(idx, i), br::view_at(text, i)));
+		}
+
+		BR_ASSERT(br::eq(br::substr(idx, 17, 6), cstr("Γαζέες")));
+		BR_ASSERT(br::eq(br::substr(text, 17, 6), cstr("Γαζέες")));
+
+		idx = br::destroy_utf_index(idx);
+	}
+
+	// Numeric parsing.
+	{
+		auto r = br::parse_int<br::i32_t>(cstr("-1234567890123,"));
+		BR_ASSERT(not r.ok);
+
+		r = br::parse_int<br::i32_t>(cstr("-2147483648,"));
+		BR_ASSERT(r.ok and r.value == -2147483648ll and br::eq(r.rest, cstr(",")));
+
+		BR_ASSERT(not br::parse_int<br::u8_t>(cstr("256")).ok);
+		BR_ASSERT(not br::parse_int<br::u8_t>(cstr("-1")).ok);
+		BR_ASSERT(not br::parse_int(cstr("18446744073709551616")).ok);
+		BR_ASSERT(br::parse_int(cstr("18446744073709551615")).value == 18446744073709551615ull);
+		BR_ASSERT(br::to_int(cstr("123abc")) == 123);
+
+		BR_ASSERT(br::parse_hex<br::u32_t>(cstr("DeadBeef")).value == 0xDEADBEEF);
+		BR_ASSERT(br::parse_bin<br::u16_t>(cstr("1010101111001101")).value == 0xABCD);
+
+		auto f = br::parse_float(cstr("-1.25e-3pt"));
+		BR_ASSERT(f.ok and f.value == -1.25e-3 and br::eq(f.rest, cstr("pt")));
+		BR_ASSERT(br::parse_float(cstr("2.2250738585072011e-308")).value == 2.2250738585072011e-308);
+		BR_ASSERT(br::parse_float(cstr("0.1000000000000000000000000001")).value == 0.1);
+		BR_ASSERT(not br::parse_float(cstr("pt")).ok);
+	}
+
 	br::char_t valid[] = { 915, 945, 950, 941, 949, 962 };
 
 	{
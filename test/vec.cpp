@@ -0,0 +1,124 @@
+#include <lib/def.hpp>
+#include <lib/exit.hpp>
+#include <lib/assert.hpp>
+#include <lib/mem.hpp>
+#include <lib/vec.hpp>
+
+// Grow a vector to `n` elements and check its contents.
+template <typename V>
+V fill_and_check(V v, br::size_t n) {
+	for (br::index_t i = br::length(v); i != n; ++i)
+		v = br::push(v, (br::u32_t)(i * 3));
+
+	BR_ASSERT(br::length(v) == n);
+	BR_ASSERT(br::capacity(v) >= n);
+
+	for (br::index_t i = 0; i != n; ++i)
+		BR_ASSERT(*br::data(v, i) == i * 3);
+
+	return v;
+}
+
+struct point {
+	br::u32_t x, y, z, w, t;
+};
+
+int main(int argc, const char* argv[]) {
+	// The default heap allocator takes no space.
+	BR_STATIC_ASSERT(sizeof(br::vec<br::u32_t>) == 3 * sizeof(br::size_t));
+
+	{
+		auto v = fill_and_check(br::make_vec<br::u32_t>(), 1000);
+		v = br::reserve(v, 100);
+		BR_ASSERT(br::capacity(v) >= 1100 and *br::data(v, 999) == 999 * 3);
+
+		// Room is counted from the length like `small_vec`.
+		const auto room = br::capacity(v) - br::length(v);
+		v = br::reserve(v, room);
+		BR_ASSERT(br::capacity(v) == 1000 + room);
+		v = br::reserve(v, room + 1);
+		BR_ASSERT(br::capacity(v) == 1001 + room and *br::data(v, 999) == 999 * 3);
+		v = br::destroy_vec(v);
+	}
+
+	// Large vectors move to mapped memory and smaller blocks back to
+	// the heap.
+	{
+		auto v = fill_and_check(br::make_vec<br::u32_t>(), 4 * br::MAP_THRESHOLD_LENGTH / sizeof(br::u32_t));
+		v = br::destroy_vec(v);
+
+		v = br::reserve(br::make_vec<br::u32_t>(), br::MAP_THRESHOLD_LENGTH);
+		v = fill_and_check(v, 10);
+
+		// `vec` never shrinks so go through the allocator directly.
+		const br::size_t small = 100;
+		v.data = br::allocate(br::allocator(v), v.data, v.capacity, small, br::alloc_site::current());
+		v.capacity = small;
+
+		for (br::index_t i = 0; i != 10; ++i)
+			BR_ASSERT(*br::data(v, i) == i * 3);
+
+		v = fill_and_check(v, small);
+		v = br::destroy_vec(v);
+	}
+
+	// Arena vectors don't need destroying. The most recent one grows
+	// in place.
+	{
+		auto a = br::make_arena();
+		const auto before = br::memory_footprint(a);
+
+		auto v = br::make_vec<br::u32_t>(br::arena_allocator { &a });
+		const auto first = v.data;
+
+		v = fill_and_check(v, 1000);
+		BR_ASSERT(v.data == first);
+		BR_ASSERT(br::memory_footprint(a) == before);
+
+		// Interleaved vectors have to move but keep their contents.
+		auto w = br::make_vec<br::u32_t>(br::arena_allocator { &a });
+		v = fill_and_check(v, 1500);
+		w = fill_and_check(w, 5000);
+		v = fill_and_check(v, 20000);
+
+		BR_ASSERT(*br::data(w, 4999) == 4999 * 3);
+
+		a = br::destroy_arena(a);
+	}
+
+	// Buffer vectors stay in the buffer until they outgrow it.
+	{
+		br::u32_t buffer[64];
+
+		auto v = br::make_vec<br::u32_t>(br::buffer_allocator { buffer, sizeof(buffer) });
+		v = fill_and_check(v, 20);
+		BR_ASSERT(v.data == buffer);
+
+		v = fill_and_check(v, 1000);
+		BR_ASSERT(v.data != buffer);
+		v = br::destroy_vec(v);
+
+		auto w = br::make_vec<br::u32_t>(br::buffer_allocator { buffer, sizeof(buffer) });
+		w = fill_and_check(w, 10);
+		w = br::destroy_vec(w);
+	}
+
+	// Any number of constructor arguments, with or without the
+	// caller's site.
+	{
+		auto v = br::make_vec<point>();
+		v = br::emplace(v, 1u, 2u, 3u, 4u, 5u);
+		v = BR_EMPLACE(v, 6u, 7u, 8u, 9u, 10u);
+		v = BR_EMPLACE(v);
+
+		BR_ASSERT(br::length(v) == 3);
+		BR_ASSERT(br::data(v, 0)->t == 5 and br::data(v, 1)->x == 6);
+		v = br::destroy_vec(v);
+
+		auto w = BR_MAKE_VEC(1u, 2u, 3u);
+		BR_ASSERT(br::length(w) == 3 and *br::data(w, 2) == 3);
+		w = br::destroy_vec(w);
+	}
+
+	return br::EXIT_SUCCESS;
+}
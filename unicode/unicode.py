@@ -6,9 +6,76 @@
 # https://www.unicode.org/reports/tr44/#UnicodeData.txt
 # https://www.unicode.org/reports/tr44/#General_Category_Values
 
+# usage: unicode.py [--chains] UnicodeData.txt
+#
+# By default we emit a two-stage lookup table mapping every codepoint
+# to its general category. `--chains` emits the old range comparison
+# predicates which are only kept around to benchmark against.
+# The other UCD files are read from next to UnicodeData.txt.
 
+
+import os
 import sys
 
+MAX_CODEPOINT = 0x10FFFF
+
+# Order matches TR44. Unassigned codepoints (Cn) don't appear in
+# UnicodeData.txt so everything defaults to it.
+CATEGORIES = [
+	"lu", "ll", "lt", "lm", "lo",
+	"mn", "mc", "me",
+	"nd", "nl", "no",
+	"pc", "pd", "ps", "pe", "pi", "pf", "po",
+	"sm", "sc", "sk", "so",
+	"zs", "zl", "zp",
+	"cc", "cf", "cs", "co", "cn",
+]
+
+# Bits of the property table. Composite predicates test a mask of
+# these with a single lookup. Surrogate, private use and unassigned
+# codepoints have no properties.
+PROPERTIES = {
+	"letter":      ["lu", "ll", "lt", "lm", "lo"],
+	"mark":        ["mn", "mc", "me"],
+	"number":      ["nd", "nl", "no"],
+	"punctuation": ["pc", "pd", "ps", "pe", "pi", "pf", "po"],
+	"symbol":      ["sm", "sc", "sk", "so"],
+	"space":       ["zs"],
+	"line":        ["zl", "zp"],
+	"control":     ["cc", "cf"],
+}
+
+ASCII_LENGTH = 128
+
+# Simple case folding (CaseFolding.txt statuses C and S) is the
+# lowercase of the uppercase except for Cherokee, which folds to
+# uppercase for stability, and the Turkic dotted/dotless i which only
+# have Turkic (T) or full (F) foldings.
+CHEROKEE = [*range(0x13A0, 0x13FE), *range(0xAB70, 0xABC0)]
+FOLD_SELF = [0x0130, 0x0131]
+
+# Normalization (https://www.unicode.org/reports/tr15/).
+# NFC_Quick_Check and Full_Composition_Exclusion come from
+# DerivedNormalizationProps.txt.
+QUICK_CHECK = ["yes", "no", "maybe"]
+
+# Grapheme clusters (https://www.unicode.org/reports/tr29/).
+# Grapheme_Cluster_Break comes from GraphemeBreakProperty.txt and
+# Extended_Pictographic from emoji-data.txt. Extended pictographic
+# characters are all `Other` so they get a value of their own for
+# rule GB11.
+GRAPHEME_BREAKS = [
+	"other", "cr", "lf", "control", "extend", "zwj", "regional_indicator",
+	"prepend", "spacing_mark", "l", "v", "t", "lv", "lvt", "pictographic",
+]
+
+# Display width (https://www.unicode.org/reports/tr11/).
+# East_Asian_Width Wide and Fullwidth from EastAsianWidth.txt take two
+# columns. Everything else takes one except for nonspacing and format
+# characters (and the V and T conjoining jamo) which take none.
+ZERO_WIDTH = ["mn", "me", "cf", "cc"]
+
+
 def generate_or(values):
 	values.sort()
 	out = []
@@ -52,31 +119,371 @@ def generate_function(fn, values):
 	return f"constexpr bool {fn}(char_t c) {{ return ({generate_or(values)}); }}"
 
 
-with open(sys.argv[1]) as f:
-	codepoints = f.readlines()
+def parse(lines):
+	lookup = {}
+	canonical = {}
+	combining = {}
+	cases = {}
+	first = None
+
+	for c in lines:
+		code, \
+		name, \
+		general_category, \
+		canonical_combining_class, \
+		bidi_class, \
+		decomposition, \
+		numeric_type, numeric_digit, numeric_numeric, \
+		bidi_mirrored, \
+		uc1name, \
+		iso_comment, \
+		simple_uppercase_mapping, \
+		simple_lowercase_mapping, \
+		simple_titlecase_mapping, \
+			= c.split(";")
+
+		key = general_category.lower()
+		code = int(code, 16)
+
+		# Compatibility mappings start with a `<tag>`.
+		if decomposition and not decomposition.startswith("<"):
+			canonical[code] = [int(x, 16) for x in decomposition.split()]
+
+		if int(canonical_combining_class):
+			combining[code] = int(canonical_combining_class)
+
+		if simple_uppercase_mapping or simple_lowercase_mapping:
+			cases[code] = (
+				int(simple_uppercase_mapping, 16) if simple_uppercase_mapping else code,
+				int(simple_lowercase_mapping, 16) if simple_lowercase_mapping else code,
+			)
+
+		# Large blocks (CJK, Hangul, private use...) are given as
+		# a pair of `<..., First>` and `<..., Last>` entries.
+		if name.endswith(", First>"):
+			first = code
+			continue
+
+		lookup.setdefault(key, []);
+
+		if name.endswith(", Last>"):
+			lookup[key].extend(range(first, code + 1))
+
+		else:
+			lookup[key].append(code)
+
+	return lookup, canonical, combining, cases
+
+
+# Lines of `code(..code) ; field(; field)` from the UCD property files
+# with everything after a `#` ignored. Returns the codepoints for each
+# distinct list of fields, joined with `;`.
+def parse_ranges(lines):
+	ranges = {}
+
+	for line in lines:
+		line = line.split("#")[0].strip()
+
+		if not line:
+			continue
+
+		codes, *fields = [x.strip() for x in line.split(";")]
+		first, _, last = codes.partition("..")
+
+		ranges.setdefault(";".join(fields), []).extend(range(int(first, 16), int(last or first, 16) + 1))
+
+	return ranges
+
+
+# Full canonical decomposition (NFD without reordering).
+def decompose_canonical(code, canonical):
+	if code not in canonical:
+		return [code]
+
+	return [y for x in canonical[code] for y in decompose_canonical(x, canonical)]
+
+
+def grapheme_breaks(breaks, emoji):
+	index = GRAPHEME_BREAKS.index
+	values = [index("other")] * (MAX_CODEPOINT + 1)
+
+	for code in emoji["Extended_Pictographic"]:
+		values[code] = index("pictographic")
+
+	# `SpacingMark` in the file is `spacing_mark` here.
+	names = { key.replace("_", ""): key for key in GRAPHEME_BREAKS }
+
+	for key, codes in breaks.items():
+		for code in codes:
+			assert values[code] == index("other") or key == "Other"
+			values[code] = index(names[key.lower().replace("_", "")])
+
+	return values
+
+
+def widths(lookup, east_asian, breaks):
+	values = [1] * (MAX_CODEPOINT + 1)
+
+	for key in ["W", "F"]:
+		for code in east_asian.get(key, []):
+			values[code] = 2
+
+	for key in ZERO_WIDTH:
+		for code in lookup.get(key, []):
+			values[code] = 0
+
+	for code in [*breaks["V"], *breaks["T"]]:
+		values[code] = 0
+
+	return values
+
+
+# Pairs which compose to a primary composite and the NFC_Quick_Check
+# value of every codepoint. Hangul syllables aren't in `canonical` as
+# they are composed algorithmically.
+def compositions(canonical, normalization):
+	excluded = set(normalization["Full_Composition_Exclusion"])
+	pairs = {tuple(mapping): code for code, mapping in canonical.items() if code not in excluded}
+
+	quick_check = [QUICK_CHECK.index("yes")] * (MAX_CODEPOINT + 1)
+
+	for key in ["no", "maybe"]:
+		for code in normalization["NFC_QC;" + key[0].upper()]:
+			quick_check[code] = QUICK_CHECK.index(key)
+
+	return pairs, quick_check
+
+
+# Split `values` into blocks of 2^shift and deduplicate them.
+# Returns (stage1, stage2) where stage1 holds the index of each
+# block in stage2.
+def build_trie(values, shift):
+	size = 1 << shift
+	blocks = {}
+	stage1 = []
+	stage2 = []
+
+	for i in range(0, len(values), size):
+		block = tuple(values[i:i + size])
+
+		if block not in blocks:
+			blocks[block] = len(blocks)
+			stage2.extend(block)
+
+		stage1.append(blocks[block])
+
+	return stage1, stage2
+
+
+def ctype(values):
+	mx = max(values)
+
+	if mx <= 0xFF:
+		return "u8_t", 1
+
+	if mx <= 0xFFFF:
+		return "u16_t", 2
+
+	if mx <= 0xFFFFFFFF:
+		return "u32_t", 4
+
+	return "u64_t", 8
+
+
+# Pick the block size that gives the smallest pair of tables.
+def smallest_trie(values):
+	best = None
+
+	for shift in range(4, 12):
+		stage1, stage2 = build_trie(values, shift)
+		size = len(stage1) * ctype(stage1)[1] + len(stage2) * ctype(stage2)[1]
+
+		if best is None or size < best[0]:
+			best = (size, shift, stage1, stage2)
+
+	return best[1:]
+
+
+def generate_array(type, name, values):
+	out = [f"constexpr {type} {name}[] = {{"]
+	suffix = "ull" if type == "u64_t" else ""
+	per_line = 6 if type == "u64_t" else 24
+
+	for i in range(0, len(values), per_line):
+		out.append("\t" + ", ".join(f"{x}{suffix}" for x in values[i:i + per_line]) + ",")
+
+	out.append("};")
+
+	return "\n".join(out)
+
+
+def generate_trie(name, values):
+	shift, stage1, stage2 = smallest_trie(values)
+
+	return "\n\n".join([
+		f"constexpr size_t INTERNAL_{name}_SHIFT__ = {shift};",
+		generate_array(ctype(stage1)[0], f"INTERNAL_{name}_STAGE1__", stage1),
+		generate_array(ctype(stage2)[0], f"INTERNAL_{name}_STAGE2__", stage2),
+	])
+
+
+# Pack a set of codepoints into 64 bit words, one bit per codepoint,
+# then deduplicate runs of words with a two-stage table.
+def generate_bitmap(name, codes):
+	words = [0] * ((MAX_CODEPOINT + 1) // 64)
+
+	for code in codes:
+		words[code // 64] |= 1 << (code % 64)
+
+	return "\n\n".join([
+		generate_array("u64_t", f"INTERNAL_{name}_ASCII__", words[:ASCII_LENGTH // 64]),
+		generate_trie(name, words),
+	])
+
+
+# Case mappings are stored as deltas from the codepoint. Most
+# letters in a script share a delta so every codepoint maps to an
+# index into a small table of (lower, upper, fold) deltas.
+def case_deltas(cases):
+	upper = lambda c: cases.get(c, (c, c))[0]
+	lower = lambda c: cases.get(c, (c, c))[1]
+
+	deltas = [(0, 0, 0)]
+	values = [0] * (MAX_CODEPOINT + 1)
+
+	for code in cases:
+		fold = lower(upper(code))
+
+		if code in CHEROKEE:
+			fold = upper(code)
+
+		if code in FOLD_SELF:
+			fold = code
+
+		delta = (lower(code) - code, upper(code) - code, fold - code)
+
+		if delta not in deltas:
+			deltas.append(delta)
+
+		values[code] = deltas.index(delta)
+
+	return deltas, values
+
+
+# Every codepoint maps to an index into a table of
+# (combining class, quick check) pairs and, if it has a canonical
+# decomposition, to `offset << 3 | length` of its full decomposition
+# in a flat array.
+def generate_normalization(canonical, combining, normalization):
+	pairs, quick_check = compositions(canonical, normalization)
+
+	info = [(0, QUICK_CHECK.index("yes"))]
+	info_values = [0] * (MAX_CODEPOINT + 1)
+
+	for code in range(MAX_CODEPOINT + 1):
+		entry = (combining.get(code, 0), quick_check[code])
+
+		if entry == info[0]:
+			continue
+
+		if entry not in info:
+			info.append(entry)
+
+		info_values[code] = info.index(entry)
+
+	data = []
+	offsets = [0] * (MAX_CODEPOINT + 1)
+
+	for code in sorted(canonical):
+		mapping = decompose_canonical(code, canonical)
+		assert len(mapping) < 8
+
+		offsets[code] = (len(data) << 3) | len(mapping)
+		data.extend(mapping)
+
+	assert len(data) < (1 << 13)
+
+	keys = sorted(pairs)
+
+	return "\n\n".join([
+		"using quick_check_t = u8_t;",
+		"enum: quick_check_t {\n" + "".join(f"\tQUICK_CHECK_{key.upper()},\n" for key in QUICK_CHECK) + "};",
+		"constexpr u8_t INTERNAL_NORMALIZATION_INFO__[][2] = {\n" + "".join(f"\t{{ {ccc}, {qc} }},\n" for ccc, qc in info) + "};",
+		generate_trie("NORMALIZATION", info_values),
+		generate_array("u32_t", "INTERNAL_DECOMPOSITION_DATA__", data),
+		generate_trie("DECOMPOSITION", offsets),
+		generate_array("u64_t", "INTERNAL_COMPOSITION_KEYS__", [(a << 21) | b for a, b in keys]),
+		generate_array("u32_t", "INTERNAL_COMPOSITION_VALUES__", [pairs[k] for k in keys]),
+	])
+
+
+def generate_tables(lookup, canonical, combining, cases, core, normalization, breaks, emoji, east_asian):
+	categories = [CATEGORIES.index("cn")] * (MAX_CODEPOINT + 1)
+
+	for key, value in lookup.items():
+		for code in value:
+			categories[code] = CATEGORIES.index(key)
+
+	properties = [0] * (MAX_CODEPOINT + 1)
+
+	for bit, (key, value) in enumerate(PROPERTIES.items()):
+		for cat in value:
+			for code in lookup.get(cat, []):
+				properties[code] |= 1 << bit
+
+	out = []
+
+	out.append("// Generated by unicode/unicode.py, do not edit.")
+	out.append("using category_t = u8_t;")
+	out.append("enum: category_t {\n" + "".join(f"\tCATEGORY_{key.upper()},\n" for key in CATEGORIES) + "};")
+	out.append(generate_trie("CATEGORY", categories))
+
+	out.append("using property_t = u8_t;")
+	out.append("enum: property_t {\n" + "".join(f"\tPROPERTY_{key.upper()} = 1u << {bit},\n" for bit, key in enumerate(PROPERTIES)) + "};")
+	out.append(generate_array("property_t", "INTERNAL_PROPERTY_ASCII__", properties[:ASCII_LENGTH]))
+	out.append(generate_trie("PROPERTY", properties))
+
+	# Identifiers (https://www.unicode.org/reports/tr31/).
+	out.append(generate_bitmap("XID_START", core["XID_Start"]))
+	out.append(generate_bitmap("XID_CONTINUE", core["XID_Continue"]))
+
+	deltas, values = case_deltas(cases)
+
+	out.append("constexpr i32_t INTERNAL_CASE_DELTAS__[][3] = {\n" + "".join(f"\t{{ {l}, {u}, {f} }},\n" for l, u, f in deltas) + "};")
+	out.append(generate_trie("CASE", values))
+
+	out.append(generate_normalization(canonical, combining, normalization))
+
+	out.append("using grapheme_break_t = u8_t;")
+	out.append("enum: grapheme_break_t {\n" + "".join(f"\tGRAPHEME_BREAK_{key.upper()},\n" for key in GRAPHEME_BREAKS) + "};")
+	out.append(generate_trie("GRAPHEME_BREAK", grapheme_breaks(breaks, emoji)))
+
+	out.append(generate_trie("WIDTH", widths(lookup, east_asian, breaks)))
+
+	return "\n\n".join(out)
+
 
-lookup = {}
+if __name__ == "__main__":
+	chains = "--chains" in sys.argv
+	args = [x for x in sys.argv[1:] if x != "--chains"]
 
-for c in codepoints:
-	code, \
-	name, \
-	general_category, \
-	canonical_combining_class, \
-	bidi_class, \
-	decomposition, \
-	numeric_type, numeric_digit, numeric_numeric, \
-	bidi_mirrored, \
-	uc1name, \
-	iso_comment, \
-	simple_uppercase_mapping, \
-	simple_lowercase_mapping, \
-	simple_titlecase_mapping, \
-		= c.split(";")
+	with open(args[0]) as f:
+		lookup, canonical, combining, cases = parse(f.readlines())
 
-	key = general_category.lower()
+	def load(name):
+		with open(os.path.join(os.path.dirname(args[0]), name)) as f:
+			return parse_ranges(f.readlines())
 
-	lookup.setdefault(key, []);
-	lookup[key].append(int(code, 16))
+	if chains:
+		for key, value in lookup.items():
+			print(generate_function("is_" + key, value))
 
-for key, value in lookup.items():
-	print(generate_function("is_" + key, value))
+	else:
+		print(generate_tables(
+			lookup, canonical, combining, cases,
+			load("DerivedCoreProperties.txt"),
+			load("DerivedNormalizationProps.txt"),
+			load("GraphemeBreakProperty.txt"),
+			load("emoji-data.txt"),
+			load("EastAsianWidth.txt"),
+		))